@@ -0,0 +1,183 @@
+#pragma once
+
+#include "fmt/base.h"
+#include "fmt/format.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/* minimal micro benchmark runner
+ * every benchmark is run for a fixed amount of time per sample and the fastest sample
+ * is reported - the fastest sample is the least disturbed by the rest of the system */
+
+namespace micro_bench {
+
+/* keeps the compiler from optimising away the benchmarked work */
+template<typename T>
+inline void doNotOptimize(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    double nsPerOp;
+};
+
+using Baseline = std::map<std::string, double, std::less<>>;
+
+class Runner {
+public:
+    explicit Runner(std::string_view filter)
+        : m_filter(filter)
+    {
+    }
+
+    /* the function runs one pass over the inputs and returns the amount of operations performed */
+    template<typename Fn>
+    void run(std::string_view name, Fn&& fn)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string_view::npos) {
+            return;
+        }
+
+        using namespace std::chrono;
+
+        /* warm up caches and branch predictors */
+        fn();
+
+        double bestNsPerOp = std::numeric_limits<double>::max();
+        for (std::size_t sample = 0; sample < s_samples; sample++) {
+            uint64_t ops = 0;
+            const auto startTime = steady_clock::now();
+            auto elapsed = steady_clock::duration::zero();
+
+            do {
+                ops += fn();
+                elapsed = steady_clock::now() - startTime;
+            } while (elapsed < s_sampleTime);
+
+            bestNsPerOp = std::min(bestNsPerOp, duration_cast<duration<double, std::nano>>(elapsed).count() / ops);
+        }
+
+        m_results.emplace_back(std::string(name), bestNsPerOp);
+    }
+
+    const std::vector<Result>& getResults() const
+    {
+        return m_results;
+    }
+
+private:
+    constexpr static inline std::size_t s_samples { 5 };
+    constexpr static inline std::chrono::milliseconds s_sampleTime { 100 };
+
+    std::string_view m_filter;
+    std::vector<Result> m_results;
+};
+
+/* baselines are stored as a flat json object: { "name": ns/op, ... } */
+inline std::optional<Baseline> readBaseline(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        fmt::println("{} could not be opened", path.string());
+        return std::nullopt;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string content = buffer.str();
+
+    Baseline baseline;
+    std::size_t pos = 0;
+
+    while ((pos = content.find('"', pos)) != std::string::npos) {
+        const auto nameEnd = content.find('"', pos + 1);
+        const auto colon = content.find(':', nameEnd);
+        if (nameEnd == std::string::npos || colon == std::string::npos) {
+            fmt::println("{} is not a valid baseline", path.string());
+            return std::nullopt;
+        }
+
+        const std::string name = content.substr(pos + 1, nameEnd - pos - 1);
+
+        const auto valueStart = content.find_first_not_of(" \t\n\r", colon + 1);
+        const char* begin = content.data() + std::min(valueStart, content.size());
+
+        double value {};
+        const auto [ptr, ec] = std::from_chars(begin, content.data() + content.size(), value);
+        if (ec != std::errc()) {
+            fmt::println("{} has an invalid value for {}", path.string(), name);
+            return std::nullopt;
+        }
+
+        baseline[name] = value;
+        pos = ptr - content.data();
+    }
+
+    return baseline;
+}
+
+inline bool writeBaseline(const std::filesystem::path& path, const std::vector<Result>& results)
+{
+    std::ofstream file(path);
+    if (!file) {
+        fmt::println("{} could not be opened", path.string());
+        return false;
+    }
+
+    file << "{\n";
+    for (std::size_t i = 0; i < results.size(); i++) {
+        file << fmt::format("    \"{}\": {:.3f}{}\n", results[i].name, results[i].nsPerOp, i + 1 < results.size() ? "," : "");
+    }
+    file << "}\n";
+
+    return true;
+}
+
+/* prints the results - compared against the baseline if provided
+ * returns the amount of benchmarks that are slower than the baseline by more than the tolerance */
+inline std::size_t printResults(const std::vector<Result>& results, const std::optional<Baseline>& baseline, double tolerancePercent)
+{
+    std::size_t regressions = 0;
+
+    if (baseline.has_value()) {
+        fmt::println("{:<40} {:>12} {:>12} {:>9}", "benchmark", "ns/op", "baseline", "diff");
+    } else {
+        fmt::println("{:<40} {:>12}", "benchmark", "ns/op");
+    }
+
+    for (const auto& result : results) {
+        if (!baseline.has_value()) {
+            fmt::println("{:<40} {:>12.2f}", result.name, result.nsPerOp);
+            continue;
+        }
+
+        const auto itr = baseline->find(result.name);
+        if (itr == baseline->end()) {
+            fmt::println("{:<40} {:>12.2f} {:>12}", result.name, result.nsPerOp, "-");
+            continue;
+        }
+
+        const double diffPercent = 100.0 * (result.nsPerOp - itr->second) / itr->second;
+        const bool regressed = diffPercent > tolerancePercent;
+        regressions += regressed;
+
+        fmt::println("{:<40} {:>12.2f} {:>12.2f} {:>+8.1f}%{}", result.name, result.nsPerOp, itr->second, diffPercent, regressed ? "  REGRESSION" : "");
+    }
+
+    return regressions;
+}
+
+}
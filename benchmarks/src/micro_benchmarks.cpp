@@ -0,0 +1,286 @@
+#include "micro_bench.h"
+
+#include "core/move_handling.h"
+#include "core/transposition.h"
+#include "evaluation/see_swap.h"
+#include "evaluation/static_evaluation.h"
+#include "parsing/fen_parser.h"
+#include "search/history_moves.h"
+#include "search/move_picker.h"
+#include "syzygy/syzygy.h"
+#include "tools/bench.h"
+
+#include <charconv>
+#include <memory>
+#include <span>
+#include <vector>
+
+/* times the hot primitives of the engine in isolation over the bench positions
+ *
+ * usage: meltdown-micro-benchmarks [options]
+ *   --filter <name>        only run benchmarks containing <name>
+ *   --baseline <file>      compare against a baseline - exits with 1 on regressions
+ *   --tolerance <percent>  allowed slowdown compared to the baseline (default 10)
+ *   --save <file>          store the results as a baseline */
+
+using namespace micro_bench;
+
+namespace {
+
+struct Position {
+    BitBoard board;
+    movegen::ValidMoves moves;
+    movegen::ValidMoves captures;
+};
+
+/* percentages can be fractional, eg: 2.5 - negative values are rejected */
+std::optional<double> parsePercent(std::string_view str)
+{
+    double result {};
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), result);
+
+    if (ec != std::errc() || ptr != str.data() + str.size() || !(result >= 0.0)) {
+        return std::nullopt;
+    }
+
+    return result;
+}
+
+template<movegen::MoveType moveType>
+void runMoveGen(Runner& runner, std::string_view name, const std::vector<Position>& positions)
+{
+    runner.run(name, [&] {
+        for (const auto& position : positions) {
+            movegen::ValidMoves moves;
+            core::getAllMoves<moveType>(position.board, moves);
+            doNotOptimize(moves);
+        }
+
+        return positions.size();
+    });
+}
+
+void runBenchmarks(Runner& runner, const std::vector<Position>& positions)
+{
+    runner.run("core::performMove", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            for (const auto& move : position.moves) {
+                doNotOptimize(core::performMove(position.board, move));
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+
+    runMoveGen<movegen::MovePseudoLegal>(runner, "core::getAllMoves<MovePseudoLegal>", positions);
+    runMoveGen<movegen::MoveCapture>(runner, "core::getAllMoves<MoveCapture>", positions);
+    runMoveGen<movegen::MoveNoisy>(runner, "core::getAllMoves<MoveNoisy>", positions);
+
+    runner.run("core::isKingAttacked", [&] {
+        for (const auto& position : positions) {
+            doNotOptimize(core::isKingAttacked(position.board));
+        }
+
+        return positions.size();
+    });
+
+    auto staticEval = std::make_unique<evaluation::StaticEvaluation>();
+    runner.run("StaticEvaluation::get", [&] {
+        for (const auto& position : positions) {
+            doNotOptimize(staticEval->get(position.board));
+        }
+
+        return positions.size();
+    });
+
+    /* piece lookups - the bitboard scan against the mailbox */
+    runner.run("BitBoard::getAttackerAtSquare", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            for (const auto& move : position.moves) {
+                doNotOptimize(position.board.getAttackerAtSquare(move.fromSquare(), position.board.player));
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+
+    runner.run("BitBoard::getAttackerAt", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            for (const auto& move : position.moves) {
+                doNotOptimize(position.board.getAttackerAt(move.fromPos(), position.board.player));
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+
+    runner.run("SeeSwap::isGreaterThanMargin", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            for (const auto& move : position.captures) {
+                doNotOptimize(evaluation::SeeSwap::isGreaterThanMargin(position.board, move, 0));
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+
+    runner.run("SeeSwap::getCaptureScore", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            for (const auto& move : position.captures) {
+                doNotOptimize(evaluation::SeeSwap::getCaptureScore(position.board, move));
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+
+    auto historyMoves = std::make_unique<search::HistoryMoves>();
+    runner.run("HistoryMoves::update", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            for (const auto& move : position.moves) {
+                historyMoves->update(position.board, move, 1);
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+
+    /* probe results as handed out by the tablebases - one for every move */
+    std::vector<std::pair<const BitBoard*, uint32_t>> tbResults;
+    for (const auto& position : positions) {
+        for (const auto& move : position.moves) {
+            uint32_t res = TB_SET_FROM(0u, static_cast<uint32_t>(move.fromPos()));
+            res = TB_SET_TO(res, static_cast<uint32_t>(move.toPos()));
+            tbResults.emplace_back(&position.board, res);
+        }
+    }
+
+    runner.run("syzygy::resultToMove", [&] {
+        for (const auto& [board, res] : tbResults) {
+            doNotOptimize(syzygy::resultToMove(*board, res));
+        }
+
+        return tbResults.size();
+    });
+
+    /* the keys of every child position - spread over a table larger than the caches */
+    std::vector<uint64_t> keys;
+    for (const auto& position : positions) {
+        for (const auto& move : position.moves) {
+            keys.push_back(core::performMove(position.board, move).hash);
+        }
+    }
+
+    core::TranspositionTable::setSizeMb(64);
+
+    runner.run("TranspositionTable::writeEntry", [&] {
+        for (const auto key : keys) {
+            core::TranspositionTable::writeEntry(key, 10, 10, movegen::nullMove(), false, 5, 0, core::TtExact);
+        }
+
+        return keys.size();
+    });
+
+    runner.run("TranspositionTable::probe", [&] {
+        for (const auto key : keys) {
+            doNotOptimize(core::TranspositionTable::probe(key));
+        }
+
+        return keys.size();
+    });
+
+    auto searchTables = std::make_unique<search::SearchTables>();
+    runner.run("MovePicker::pickNextMove", [&] {
+        uint64_t ops = 0;
+        for (const auto& position : positions) {
+            search::MovePicker<movegen::MovePseudoLegal> picker { *searchTables, 0, search::PickerPhase::TtMove };
+            while (const auto move = picker.pickNextMove(position.board)) {
+                doNotOptimize(*move);
+                ops++;
+            }
+        }
+
+        return ops;
+    });
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    std::string_view filter;
+    std::optional<std::string_view> baselinePath;
+    std::optional<std::string_view> savePath;
+    double tolerancePercent = 10.0;
+
+    const auto args = std::span(argv, argc).subspan(1);
+    for (std::size_t i = 0; i < args.size(); i++) {
+        const std::string_view arg = args[i];
+        const std::optional<std::string_view> value = i + 1 < args.size() ? std::make_optional(args[i + 1]) : std::nullopt;
+
+        if (!value.has_value()) {
+            fmt::println("missing value for {}", arg);
+            return 1;
+        }
+
+        if (arg == "--filter") {
+            filter = *value;
+        } else if (arg == "--baseline") {
+            baselinePath = *value;
+        } else if (arg == "--save") {
+            savePath = *value;
+        } else if (arg == "--tolerance" && parsePercent(*value).has_value()) {
+            tolerancePercent = *parsePercent(*value);
+        } else {
+            fmt::println("invalid argument: {} {}", arg, *value);
+            return 1;
+        }
+
+        i++;
+    }
+
+    std::optional<Baseline> baseline;
+    if (baselinePath.has_value()) {
+        baseline = readBaseline(*baselinePath);
+        if (!baseline.has_value()) {
+            return 1;
+        }
+    }
+
+    std::vector<Position> positions;
+    for (const auto fen : tools::Bench::s_benchPositions) {
+        Position position { parsing::FenParser::parse(fen).value(), {}, {} };
+        core::getAllMoves<movegen::MovePseudoLegal>(position.board, position.moves);
+        core::getAllMoves<movegen::MoveCapture>(position.board, position.captures);
+
+        positions.push_back(position);
+    }
+
+    Runner runner(filter);
+    runBenchmarks(runner, positions);
+
+    const std::size_t regressions = printResults(runner.getResults(), baseline, tolerancePercent);
+
+    if (savePath.has_value() && !writeBaseline(*savePath, runner.getResults())) {
+        return 1;
+    }
+
+    if (regressions > 0) {
+        fmt::println("\n{} benchmark(s) regressed by more than {}%", regressions, tolerancePercent);
+        return 1;
+    }
+
+    return 0;
+}
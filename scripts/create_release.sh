@@ -10,6 +10,8 @@ RELEASE_DIR=".release"
 
 # List of elements that we cross compile.
 # They refer to the .txt files in our 'targets' folder
+# NOTE: the v2 builds select PEXT sliders and AVX2/AVX512 nnue kernels at runtime, but
+# search and eval are still compiled for v2 - the v3 builds are faster on v3 hosts
 ARCHS=(
     "linux-x86-64-v2"
     "linux-x86-64-v3"
@@ -0,0 +1,15 @@
+#!/bin/bash
+
+set -e
+
+BUILD_DIR=".build-micro-benchmarks"
+
+# timings are only meaningful for optimized native builds
+if [ ! -d "$BUILD_DIR" ]; then
+    meson setup "$BUILD_DIR" --buildtype=release -Dcpp_args=-march=native -Dc_args=-march=native -Dmicro-benchmarks=true
+fi
+
+meson compile -C "$BUILD_DIR" meltdown-micro-benchmarks
+
+# all arguments are forwarded, eg: --baseline baseline.json --tolerance 5
+"$BUILD_DIR"/benchmarks/meltdown-micro-benchmarks "$@"
@@ -3,12 +3,15 @@
 #include "core/board_defs.h"
 
 #include "core/bit_board.h"
+#include "core/mask_tables.h"
 #include "movegen/bishops.h"
 #include "movegen/kings.h"
 #include "movegen/knights.h"
+#include "movegen/pawns.h"
 #include "movegen/rooks.h"
 #include "utils/bit_operations.h"
 
+#include <bit>
 #include <cstdint>
 
 namespace attackgen {
@@ -117,6 +120,99 @@ constexpr uint64_t getAllAttacks(const BitBoard& board)
     return attacks;
 }
 
+// Helper: using inside loops means redundant colour checks
+constexpr uint64_t getAllAttacks(const BitBoard& board, Player player)
+{
+    if (player == PlayerWhite)
+        return getAllAttacks<PlayerWhite>(board);
+    else
+        return getAllAttacks<PlayerBlack>(board);
+}
+
+/* checks if the given position is attacked by any piece of the player
+ * much cheaper than generating the full attack map as we only look from the
+ * target square and outwards */
+template<Player player>
+constexpr bool isSquareAttacked(const BitBoard& board, BoardPosition pos)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr bool isWhite = player == PlayerWhite;
+    constexpr Piece pawn = isWhite ? WhitePawn : BlackPawn;
+    constexpr Piece knight = isWhite ? WhiteKnight : BlackKnight;
+    constexpr Piece bishop = isWhite ? WhiteBishop : BlackBishop;
+    constexpr Piece rook = isWhite ? WhiteRook : BlackRook;
+    constexpr Piece queen = isWhite ? WhiteQueen : BlackQueen;
+    constexpr Piece king = isWhite ? WhiteKing : BlackKing;
+
+    /* a pawn of the opponent standing on pos would attack the squares our pawns must be on */
+    if (movegen::getPawnAttacksFromPos<opponent>(pos) & board.pieces[pawn])
+        return true;
+
+    if (movegen::getKnightMoves(pos) & board.pieces[knight])
+        return true;
+
+    if (movegen::getKingMoves(pos) & board.pieces[king])
+        return true;
+
+    const uint64_t occupancy = board.occupation[Both];
+    const uint64_t queens = board.pieces[queen];
+
+    if (movegen::getBishopMoves(pos, occupancy) & (board.pieces[bishop] | queens))
+        return true;
+
+    return movegen::getRookMoves(pos, occupancy) & (board.pieces[rook] | queens);
+}
+
+/* all pieces of the player attacking the given position
+ * the occupancy is given explicitly so pieces can be removed from the board (eg. a moving king) */
+template<Player player>
+constexpr uint64_t getAttackers(const BitBoard& board, BoardPosition pos, uint64_t occupancy)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr bool isWhite = player == PlayerWhite;
+    constexpr Piece pawn = isWhite ? WhitePawn : BlackPawn;
+    constexpr Piece knight = isWhite ? WhiteKnight : BlackKnight;
+    constexpr Piece bishop = isWhite ? WhiteBishop : BlackBishop;
+    constexpr Piece rook = isWhite ? WhiteRook : BlackRook;
+    constexpr Piece queen = isWhite ? WhiteQueen : BlackQueen;
+    constexpr Piece king = isWhite ? WhiteKing : BlackKing;
+
+    const uint64_t queens = board.pieces[queen];
+
+    return (movegen::getPawnAttacksFromPos<opponent>(pos) & board.pieces[pawn])
+        | (movegen::getKnightMoves(pos) & board.pieces[knight])
+        | (movegen::getKingMoves(pos) & board.pieces[king])
+        | (movegen::getBishopMoves(pos, occupancy) & (board.pieces[bishop] | queens))
+        | (movegen::getRookMoves(pos, occupancy) & (board.pieces[rook] | queens));
+}
+
+/* pieces (of either side) that are the only piece between the given king position and a slider of the player
+ * for the king's own pieces these are pins - for the player's own pieces they give discovered check when moved */
+template<Player player>
+constexpr uint64_t getSliderBlockers(const BitBoard& board, BoardPosition kingPos)
+{
+    constexpr bool isWhite = player == PlayerWhite;
+    constexpr Piece bishop = isWhite ? WhiteBishop : BlackBishop;
+    constexpr Piece rook = isWhite ? WhiteRook : BlackRook;
+    constexpr Piece queen = isWhite ? WhiteQueen : BlackQueen;
+
+    /* sliders that would attack the king on an empty board */
+    const uint64_t queens = board.pieces[queen];
+    const uint64_t snipers = (movegen::getRookMoves(kingPos, 0) & (board.pieces[rook] | queens))
+        | (movegen::getBishopMoves(kingPos, 0) & (board.pieces[bishop] | queens));
+
+    uint64_t blockers {};
+    utils::bitIterate(snipers, [&](BoardPosition pos) {
+        const uint64_t between = core::s_betweenMaskTable[kingPos][pos] & board.occupation[Both];
+
+        if (std::has_single_bit(between)) {
+            blockers |= between;
+        }
+    });
+
+    return blockers;
+}
+
 /* computes discovered attacks based on the given position
  * NOTE: queen attacks are not included - it's only rook and bishops */
 template<Player player>
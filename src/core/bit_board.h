@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/board_defs.h"
+#include "evaluation/term_score.h"
 #include "magic_enum/magic_enum.hpp"
 #include <array>
 #include <cstdint>
@@ -20,6 +21,52 @@ struct BitBoard {
         occupation[Both] = occupation[White] | occupation[Black];
     }
 
+    /* piece on the given position - a single lookup in the mailbox */
+    constexpr std::optional<Piece> getPieceAt(BoardPosition pos) const
+    {
+        const Piece piece = pieceOn[pos];
+        return piece == s_noPiece ? std::nullopt : std::make_optional(piece);
+    }
+
+    /* piece of the player on the given position */
+    template<Player player>
+    constexpr std::optional<Piece> getAttackerAt(BoardPosition pos) const
+    {
+        const Piece piece = pieceOn[pos];
+
+        if constexpr (player == PlayerWhite) {
+            return piece <= WhiteKing ? std::make_optional(piece) : std::nullopt;
+        } else {
+            return piece >= BlackPawn && piece <= BlackKing ? std::make_optional(piece) : std::nullopt;
+        }
+    }
+
+    /* piece of the opponent on the given position */
+    template<Player player>
+    constexpr std::optional<Piece> getTargetAt(BoardPosition pos) const
+    {
+        return getAttackerAt<nextPlayer(player)>(pos);
+    }
+
+    // Helper: calling within loops will mean redundant colour checks
+    constexpr std::optional<Piece> getAttackerAt(BoardPosition pos, Player player) const
+    {
+        if (player == PlayerWhite)
+            return getAttackerAt<PlayerWhite>(pos);
+        else
+            return getAttackerAt<PlayerBlack>(pos);
+    }
+
+    // Helper: calling within loops will mean redundant colour checks
+    constexpr std::optional<Piece> getTargetAt(BoardPosition pos, Player player) const
+    {
+        if (player == PlayerWhite)
+            return getTargetAt<PlayerWhite>(pos);
+        else
+            return getTargetAt<PlayerBlack>(pos);
+    }
+
+    /* scans the piece bitboards - prefer the mailbox lookups above in hot paths */
     template<Player player>
     constexpr std::optional<Piece> getAttackerAtSquare(uint64_t square) const
     {
@@ -78,11 +125,6 @@ struct BitBoard {
             return getTargetAtSquare<PlayerBlack>(square);
     }
 
-    constexpr bool isQuietPosition() const
-    {
-        return (attacks[PlayerWhite] & occupation[PlayerBlack]) == 0 && (attacks[PlayerBlack] & occupation[PlayerWhite]) == 0;
-    }
-
     /* this is a very primitive way of checking for zugzwang position
      * zugzwang is _very rare_ to happen outside of these conditions
      * so for most cases this should be _super good enough_ */
@@ -139,7 +181,14 @@ struct BitBoard {
 
     std::array<uint64_t, magic_enum::enum_count<Piece>()> pieces {};
     std::array<uint64_t, magic_enum::enum_count<Occupation>()> occupation {};
-    std::array<uint64_t, magic_enum::enum_count<Player>()> attacks {};
+
+    /* mailbox of the piece on each square (s_noPiece if empty) - mirrors the piece bitboards
+     * kept in sync by performMove and the FEN parser */
+    std::array<Piece, s_amountSquares> pieceOn = [] {
+        std::array<Piece, s_amountSquares> mailbox;
+        mailbox.fill(s_noPiece);
+        return mailbox;
+    }();
 
     // castling
     uint64_t castlingRights {};
@@ -156,4 +205,12 @@ struct BitBoard {
     /* hashes for the current position */
     uint64_t hash {};
     uint64_t kpHash {};
+
+    /* pieces giving check to the player to move - kept up to date by performMove */
+    uint64_t checkers {};
+
+    /* material + psqt score (seen from white) and game phase
+     * kept up to date by performMove so evaluation doesn't have to loop all pieces */
+    evaluation::TermScore psqtScore {};
+    uint8_t phase {};
 };
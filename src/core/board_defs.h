@@ -67,6 +67,9 @@ template<typename T>
 constexpr static inline auto s_whitePieces = std::to_array<Piece>({ WhitePawn, WhiteKnight, WhiteBishop, WhiteRook, WhiteQueen, WhiteKing });
 constexpr static inline auto s_blackPieces = std::to_array<Piece>({ BlackPawn, BlackKnight, BlackBishop, BlackRook, BlackQueen, BlackKing });
 
+/* marks an empty square in the mailbox of the board - not a valid piece */
+constexpr static inline Piece s_noPiece { static_cast<Piece>(0xff) };
+
 enum PromotionType : uint8_t {
     PromotionNone = 0,
     PromotionQueen,
@@ -170,6 +173,7 @@ constexpr static inline uint64_t s_whiteOutpostRankMask = s_row4Mask | s_row5Mas
 constexpr static inline uint64_t s_blackOutpostRankMask = s_row3Mask | s_row4Mask | s_row5Mask;
 
 constexpr static inline std::size_t s_defaultTtSizeMb { 16 };
+constexpr static inline std::size_t s_maxTtSizeMb { 64 * 1024 };
 
 constexpr static inline uint8_t s_middleGamePhase { 24 };
 constexpr static inline size_t s_maxThreads { 128 };
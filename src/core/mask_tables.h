@@ -4,6 +4,9 @@
 #include "magic_enum/magic_enum.hpp"
 #include "utils/bit_operations.h"
 
+#include <array>
+#include <utility>
+
 namespace core {
 
 namespace {
@@ -238,12 +241,73 @@ constexpr auto generatePawnAttackMaskTable()
     return data;
 }
 
+/* Bitmask of the squares strictly between two positions on the same rank, file or diagonal
+ * empty if the positions aren't aligned
+ *
+ * eg: table for B2 -> F6:
+ * -8- 0 0 0 0 0 0 0 0
+ * -7- 0 0 0 0 0 0 0 0
+ * -6- 0 0 0 0 0 0 0 0
+ * -5- 0 0 0 0 1 0 0 0
+ * -4- 0 0 0 1 0 0 0 0
+ * -3- 0 0 1 0 0 0 0 0
+ * -2- 0 0 0 0 0 0 0 0
+ * -1- 0 0 0 0 0 0 0 0
+ *     A B C D E F G H
+ *
+ * the line table is the entire line through both positions (edge to edge)
+ * eg: table for B2 -> F6 is the A1-H8 diagonal */
+template<bool fullLine>
+constexpr auto generateRayTable()
+{
+    using RayTable = std::array<uint64_t, s_amountSquares>;
+    std::array<RayTable, s_amountSquares> data {};
+
+    constexpr std::array<std::pair<int, int>, 8> directions { {
+        { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 }, { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } } };
+
+    const auto onBoard = [](int row, int col) { return row >= 0 && row < 8 && col >= 0 && col < 8; };
+
+    for (int from = 0; from < s_amountSquares; from++) {
+        const int fromRow = from / 8;
+        const int fromCol = from % 8;
+
+        for (const auto& [dr, dc] : directions) {
+            uint64_t between = 0;
+
+            for (int row = fromRow + dr, col = fromCol + dc; onBoard(row, col); row += dr, col += dc) {
+                const int to = row * 8 + col;
+
+                if constexpr (fullLine) {
+                    uint64_t line = 1ULL << from;
+                    for (int r = fromRow + dr, c = fromCol + dc; onBoard(r, c); r += dr, c += dc) {
+                        line |= 1ULL << (r * 8 + c);
+                    }
+                    for (int r = fromRow - dr, c = fromCol - dc; onBoard(r, c); r -= dr, c -= dc) {
+                        line |= 1ULL << (r * 8 + c);
+                    }
+
+                    data[from][to] = line;
+                } else {
+                    data[from][to] = between;
+                }
+
+                between |= 1ULL << to;
+            }
+        }
+    }
+
+    return data;
+}
+
 constexpr auto s_fileMaskTable = generateFileMaskTable();
 constexpr auto s_isolationMaskTable = generateIsolationMaskTable();
 constexpr auto s_passedPawnMaskTable = generatePassedPawnMaskTable();
 constexpr auto s_outpostSquareMaskTable = generateOutpostSquareMaskTable();
 constexpr auto s_castlingRightMaskTable = generateCastlingRightMasks();
 constexpr auto s_pawnAttackMaskTable = generatePawnAttackMaskTable();
+constexpr auto s_betweenMaskTable = generateRayTable<false>();
+constexpr auto s_lineMaskTable = generateRayTable<true>();
 
 constexpr std::array<uint64_t, magic_enum::enum_count<Player>()> s_outpostRankMaskTable {
     s_row4Mask | s_row5Mask | s_row6Mask,
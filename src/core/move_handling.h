@@ -5,6 +5,7 @@
 #include "core/mask_tables.h"
 #include "core/transposition.h"
 #include "core/zobrist_hashing.h"
+#include "evaluation/psqt.h"
 #include "movegen/move_generation.h"
 #include "movegen/move_types.h"
 #include "parsing/piece_parsing.h"
@@ -13,26 +14,39 @@
 #include "fmt/ranges.h"
 #include "magic_enum/magic_enum.hpp"
 
+#include <array>
+#include <bit>
+
 namespace core {
 
 namespace {
 
-constexpr static inline void clearPiece(uint64_t& piece, BoardPosition pos, Piece type, uint64_t& hash)
+constexpr static inline void clearPiece(BitBoard& board, BoardPosition pos, Piece type)
 {
-    piece &= ~utils::positionToSquare(pos);
-    core::hashPiece(type, pos, hash); // remove from hash
+    board.pieces[type] &= ~utils::positionToSquare(pos);
+    board.pieceOn[pos] = s_noPiece;
+    core::hashPiece(type, pos, board.hash); // remove from hash
+    board.psqtScore -= evaluation::s_psqtTable[type][pos];
+    board.phase -= s_piecePhaseValues[type];
 }
 
-constexpr static inline void setPiece(uint64_t& piece, BoardPosition pos, Piece type, uint64_t& hash)
+constexpr static inline void setPiece(BitBoard& board, BoardPosition pos, Piece type)
 {
-    piece |= utils::positionToSquare(pos);
-    core::hashPiece(type, pos, hash); // add to hash
+    board.pieces[type] |= utils::positionToSquare(pos);
+    board.pieceOn[pos] = type;
+    core::hashPiece(type, pos, board.hash); // add to hash
+    board.psqtScore += evaluation::s_psqtTable[type][pos];
+    board.phase += s_piecePhaseValues[type];
 }
 
-constexpr static inline void movePiece(uint64_t& piece, BoardPosition fromPos, BoardPosition toPos, Piece type, uint64_t& hash)
+constexpr static inline void movePiece(BitBoard& board, BoardPosition fromPos, BoardPosition toPos, Piece type)
 {
-    clearPiece(piece, fromPos, type, hash);
-    setPiece(piece, toPos, type, hash);
+    board.pieces[type] ^= utils::positionToSquare(fromPos) | utils::positionToSquare(toPos);
+    board.pieceOn[fromPos] = s_noPiece;
+    board.pieceOn[toPos] = type;
+    core::hashPiece(type, fromPos, board.hash);
+    core::hashPiece(type, toPos, board.hash);
+    board.psqtScore += evaluation::s_psqtTable[type][toPos] - evaluation::s_psqtTable[type][fromPos];
 }
 
 constexpr inline void updateCastlingRights(BitBoard& board, BoardPosition pos)
@@ -49,21 +63,21 @@ constexpr void performCastleMove(BitBoard& newBoard, movegen::Move move)
 
     switch (move.castleType<player>()) {
     case CastleWhiteKingSide: {
-        movePiece(newBoard.pieces[WhiteKing], fromPos, toPos, WhiteKing, newBoard.hash);
-        movePiece(newBoard.pieces[WhiteRook], H1, F1, WhiteRook, newBoard.hash);
+        movePiece(newBoard, fromPos, toPos, WhiteKing);
+        movePiece(newBoard, H1, F1, WhiteRook);
     } break;
 
     case CastleWhiteQueenSide: {
-        movePiece(newBoard.pieces[WhiteKing], fromPos, toPos, WhiteKing, newBoard.hash);
-        movePiece(newBoard.pieces[WhiteRook], A1, D1, WhiteRook, newBoard.hash);
+        movePiece(newBoard, fromPos, toPos, WhiteKing);
+        movePiece(newBoard, A1, D1, WhiteRook);
     } break;
     case CastleBlackKingSide: {
-        movePiece(newBoard.pieces[BlackKing], fromPos, toPos, BlackKing, newBoard.hash);
-        movePiece(newBoard.pieces[BlackRook], H8, F8, BlackRook, newBoard.hash);
+        movePiece(newBoard, fromPos, toPos, BlackKing);
+        movePiece(newBoard, H8, F8, BlackRook);
     } break;
     case CastleBlackQueenSide: {
-        movePiece(newBoard.pieces[BlackKing], fromPos, toPos, BlackKing, newBoard.hash);
-        movePiece(newBoard.pieces[BlackRook], A8, D8, BlackRook, newBoard.hash);
+        movePiece(newBoard, fromPos, toPos, BlackKing);
+        movePiece(newBoard, A8, D8, BlackRook);
     } break;
     case CastleNone:
         assert(false);
@@ -82,14 +96,13 @@ constexpr void performPromotionMove(BitBoard& newBoard, movegen::Move move)
     constexpr Player opponent = nextPlayer(player);
 
     // first clear to be promoted pawn
-    uint64_t& pawns = newBoard.pieces[type];
-    clearPiece(pawns, move.fromPos(), type, newBoard.hash);
+    clearPiece(newBoard, move.fromPos(), type);
     core::hashPiece(type, move.fromPos(), newBoard.kpHash);
 
     /* clear piece that will be taken if capture */
     if (move.isCapture()) {
-        if (const auto victim = newBoard.getTargetAtSquare<player>(move.toSquare())) {
-            clearPiece(newBoard.pieces[victim.value()], move.toPos(), victim.value(), newBoard.hash);
+        if (const auto victim = newBoard.getTargetAt<player>(move.toPos())) {
+            clearPiece(newBoard, move.toPos(), victim.value());
 
             if (utils::isPawn<opponent>(*victim)) {
                 core::hashPiece(*victim, move.toPos(), newBoard.kpHash);
@@ -103,30 +116,108 @@ constexpr void performPromotionMove(BitBoard& newBoard, movegen::Move move)
         return;
     case PromotionQueen: {
         constexpr auto type = isWhite ? WhiteQueen : BlackQueen;
-        setPiece(newBoard.pieces[type], move.toPos(), type, newBoard.hash);
+        setPiece(newBoard, move.toPos(), type);
     } break;
     case PromotionKnight: {
         constexpr auto type = isWhite ? WhiteKnight : BlackKnight;
-        setPiece(newBoard.pieces[type], move.toPos(), type, newBoard.hash);
+        setPiece(newBoard, move.toPos(), type);
     } break;
     case PromotionBishop: {
         constexpr auto type = isWhite ? WhiteBishop : BlackBishop;
-        setPiece(newBoard.pieces[type], move.toPos(), type, newBoard.hash);
+        setPiece(newBoard, move.toPos(), type);
     } break;
     case PromotionRook: {
         constexpr auto type = isWhite ? WhiteRook : BlackRook;
-        setPiece(newBoard.pieces[type], move.toPos(), type, newBoard.hash);
+        setPiece(newBoard, move.toPos(), type);
     } break;
     }
 }
 
+/* pieces of the player that just moved giving check to the opponent king
+ * pawns and knights can only give check from the square they moved to and sliders only if
+ * the move touched a line to the king - otherwise the opponent was already in check */
+template<Player player>
+constexpr uint64_t getCheckersAfterMove(const BitBoard& newBoard, movegen::Move move)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr bool isWhite = player == PlayerWhite;
+    constexpr Piece theirKing = isWhite ? BlackKing : WhiteKing;
+    constexpr Piece pawn = isWhite ? WhitePawn : BlackPawn;
+    constexpr Piece knight = isWhite ? WhiteKnight : BlackKnight;
+    constexpr Piece bishop = isWhite ? WhiteBishop : BlackBishop;
+    constexpr Piece rook = isWhite ? WhiteRook : BlackRook;
+    constexpr Piece queen = isWhite ? WhiteQueen : BlackQueen;
+
+    if (newBoard.pieces[theirKing] == 0)
+        return 0;
+
+    const BoardPosition kingPos = utils::lsbToPosition(newBoard.pieces[theirKing]);
+
+    uint64_t checkers = ((s_pawnAttackMaskTable[opponent][kingPos] & newBoard.pieces[pawn])
+                            | (movegen::getKnightMoves(kingPos) & newBoard.pieces[knight]))
+        & move.toSquare();
+
+    /* castling moves the rook and en pessant removes a pawn - both can open or close lines */
+    const bool touchesLine = (s_lineMaskTable[kingPos][move.fromPos()] | s_lineMaskTable[kingPos][move.toPos()]) != 0;
+    if (touchesLine || move.isCastleMove() || move.takeEnPessant()) {
+        const uint64_t occupancy = newBoard.occupation[Both];
+        const uint64_t queens = newBoard.pieces[queen];
+
+        checkers |= movegen::getBishopMoves(kingPos, occupancy) & (newBoard.pieces[bishop] | queens);
+        checkers |= movegen::getRookMoves(kingPos, occupancy) & (newBoard.pieces[rook] | queens);
+    }
+
+    return checkers;
+}
+
+}
+
+/* attack map of the opponent limited to the squares our king could move or castle to
+ * the full attack map is rarely needed for move generation and most of the time
+ * the king is surrounded by its own pieces leaving only a few squares to test */
+template<Player player, movegen::MoveType type>
+constexpr uint64_t getKingDangerSquares(const BitBoard& board)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr Piece king = player == PlayerWhite ? WhiteKing : BlackKing;
+    constexpr uint64_t castlingSquares = player == PlayerWhite ? 0x7cULL : 0x7cULL << s_eightRow;
+    constexpr uint64_t castlingRights = player == PlayerWhite ? CastleWhiteKingSide | CastleWhiteQueenSide : CastleBlackKingSide | CastleBlackQueenSide;
+
+    if (board.pieces[king] == 0)
+        return 0;
+
+    uint64_t candidates = movegen::getKingMoves(utils::lsbToPosition(board.pieces[king]));
+    if constexpr (type == movegen::MovePseudoLegal) {
+        candidates &= ~board.occupation[player];
+
+        if (board.castlingRights & castlingRights) {
+            candidates |= castlingSquares;
+        }
+    } else if constexpr (type == movegen::MoveQuiet) {
+        candidates &= ~board.occupation[Both];
+
+        if (board.castlingRights & castlingRights) {
+            candidates |= castlingSquares;
+        }
+    } else {
+        candidates &= board.occupation[opponent];
+    }
+
+    uint64_t attacks {};
+    utils::bitIterate(candidates, [&](BoardPosition pos) {
+        if (attackgen::isSquareAttacked<opponent>(board, pos)) {
+            attacks |= utils::positionToSquare(pos);
+        }
+    });
+
+    return attacks;
 }
 
 template<movegen::MoveType type>
 constexpr void getAllMoves(const BitBoard& board, movegen::ValidMoves& moves)
 {
     if (board.player == PlayerWhite) {
-        const uint64_t attacks = board.attacks[PlayerBlack];
+        const uint64_t attacks = getKingDangerSquares<PlayerWhite, type>(board);
         movegen::getKingMoves<PlayerWhite, type>(moves, board, attacks);
         movegen::getPawnMoves<PlayerWhite, type>(moves, board);
         movegen::getKnightMoves<PlayerWhite, type>(moves, board);
@@ -135,7 +226,7 @@ constexpr void getAllMoves(const BitBoard& board, movegen::ValidMoves& moves)
         movegen::getQueenMoves<PlayerWhite, type>(moves, board);
         movegen::getCastlingMoves<PlayerWhite, type>(moves, board, attacks);
     } else {
-        const uint64_t attacks = board.attacks[PlayerWhite];
+        const uint64_t attacks = getKingDangerSquares<PlayerBlack, type>(board);
         movegen::getKingMoves<PlayerBlack, type>(moves, board, attacks);
         movegen::getPawnMoves<PlayerBlack, type>(moves, board);
         movegen::getKnightMoves<PlayerBlack, type>(moves, board);
@@ -146,12 +237,148 @@ constexpr void getAllMoves(const BitBoard& board, movegen::ValidMoves& moves)
     }
 }
 
+/* true if the move would be generated by getAllMoves<type>() in this position
+ * used to validate moves from the transposition table without generating all moves
+ * NOTE: moves from the table might belong to a different position (hash collision)
+ *       so nothing about the move can be assumed */
+template<Player player, movegen::MoveType type>
+constexpr bool isPseudoLegal(const BitBoard& board, movegen::Move move)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr bool isWhite = player == PlayerWhite;
+    constexpr int8_t pawnPush = isWhite ? 8 : -8;
+    constexpr uint64_t promotionRow = isWhite ? s_row7Mask : s_row2Mask;
+    constexpr uint64_t doublePushRow = isWhite ? s_row2Mask : s_row7Mask;
+
+    const auto attacker = board.getAttackerAt<player>(move.fromPos());
+    if (!attacker.has_value())
+        return false;
+
+    const uint64_t fromSquare = move.fromSquare();
+    const uint64_t toSquare = move.toSquare();
+    const int8_t distance = move.toPos() - move.fromPos();
+
+    if (toSquare & board.occupation[player])
+        return false;
+
+    const auto flag = move.getFlag();
+    const bool targetIsEnemy = toSquare & board.occupation[opponent];
+
+    /* en pessant is the only capture without a piece on the target square */
+    if (flag != movegen::MoveFlag::EnPassant && move.isCapture() != targetIsEnemy)
+        return false;
+
+    if constexpr (type == movegen::MoveCapture) {
+        if (!move.isCapture())
+            return false;
+    } else if constexpr (type == movegen::MoveNoisy) {
+        if (!move.isNoisyMove())
+            return false;
+    } else if constexpr (type == movegen::MoveQuiet) {
+        if (move.isNoisyMove())
+            return false;
+    }
+
+    if (utils::isPawn<player>(*attacker)) {
+        const bool isPromotionRow = fromSquare & promotionRow;
+        const bool isAttack = s_pawnAttackMaskTable[player][move.fromPos()] & toSquare;
+
+        switch (flag) {
+        case movegen::MoveFlag::Quiet:
+            return !isPromotionRow && distance == pawnPush;
+        case movegen::MoveFlag::DoublePush: {
+            const uint64_t passedSquare = isWhite ? fromSquare << 8 : fromSquare >> 8;
+            return (fromSquare & doublePushRow) && distance == 2 * pawnPush && !(passedSquare & board.occupation[Both]);
+        }
+        case movegen::MoveFlag::Capture:
+            return !isPromotionRow && isAttack;
+        case movegen::MoveFlag::EnPassant:
+            return board.enPessant.has_value() && *board.enPessant == move.toPos() && !(toSquare & board.occupation[Both]) && isAttack;
+        case movegen::MoveFlag::KnightPromotion:
+        case movegen::MoveFlag::BishopPromotion:
+        case movegen::MoveFlag::RookPromotion:
+        case movegen::MoveFlag::QueenPromotion:
+            return isPromotionRow && distance == pawnPush;
+        case movegen::MoveFlag::KnightPromomotionCapture:
+        case movegen::MoveFlag::BishopPromotionCapture:
+        case movegen::MoveFlag::RookPromotionCapture:
+        case movegen::MoveFlag::QueenPromotionCapture:
+            return isPromotionRow && isAttack;
+        default:
+            return false;
+        }
+    }
+
+    if (utils::isKing<player>(*attacker) && move.isCastleMove()) {
+        if constexpr (type == movegen::MoveCapture || type == movegen::MoveNoisy) {
+            return false;
+        } else {
+            const bool kingSide = flag == movegen::MoveFlag::KingCastle;
+            const CastleType castle = move.castleType<player>();
+            const BoardPosition kingPos = isWhite ? E1 : E8;
+            const BoardPosition targetPos = isWhite ? (kingSide ? G1 : C1) : (kingSide ? G8 : C8);
+            const uint64_t occupationMask = (kingSide ? 0x60ULL : 0xeULL) << (isWhite ? 0 : s_eightRow);
+            const uint64_t attackMask = (kingSide ? 0x70ULL : 0x1cULL) << (isWhite ? 0 : s_eightRow);
+
+            if (!(board.castlingRights & castle) || move.fromPos() != kingPos || move.toPos() != targetPos)
+                return false;
+
+            if (board.occupation[Both] & occupationMask)
+                return false;
+
+            bool attacked = false;
+            utils::bitIterate(attackMask, [&](BoardPosition pos) {
+                attacked |= attackgen::isSquareAttacked<opponent>(board, pos);
+            });
+
+            return !attacked;
+        }
+    }
+
+    /* all other pieces only use the quiet and capture flags */
+    if (flag != movegen::MoveFlag::Quiet && flag != movegen::MoveFlag::Capture)
+        return false;
+
+    const uint64_t occupation = board.occupation[Both];
+
+    switch (*attacker) {
+    case WhiteKnight:
+    case BlackKnight:
+        return movegen::getKnightMoves(move.fromPos()) & toSquare;
+    case WhiteBishop:
+    case BlackBishop:
+        return movegen::getBishopMoves(move.fromPos(), occupation) & toSquare;
+    case WhiteRook:
+    case BlackRook:
+        return movegen::getRookMoves(move.fromPos(), occupation) & toSquare;
+    case WhiteQueen:
+    case BlackQueen:
+        return (movegen::getRookMoves(move.fromPos(), occupation) | movegen::getBishopMoves(move.fromPos(), occupation)) & toSquare;
+    case WhiteKing:
+    case BlackKing:
+        return (movegen::getKingMoves(move.fromPos()) & toSquare) && !attackgen::isSquareAttacked<opponent>(board, move.toPos());
+    default:
+        return false;
+    }
+}
+
+template<movegen::MoveType type>
+constexpr bool isPseudoLegal(const BitBoard& board, movegen::Move move)
+{
+    if (board.player == PlayerWhite)
+        return isPseudoLegal<PlayerWhite, type>(board, move);
+    else
+        return isPseudoLegal<PlayerBlack, type>(board, move);
+}
+
 constexpr static inline bool isKingAttacked(const BitBoard& board, Player player)
 {
     if (player == PlayerWhite) {
-        return board.pieces[WhiteKing] & board.attacks[PlayerBlack];
+        const uint64_t king = board.pieces[WhiteKing];
+        return king && attackgen::isSquareAttacked<PlayerBlack>(board, utils::lsbToPosition(king));
     } else {
-        return board.pieces[BlackKing] & board.attacks[PlayerWhite];
+        const uint64_t king = board.pieces[BlackKing];
+        return king && attackgen::isSquareAttacked<PlayerWhite>(board, utils::lsbToPosition(king));
     }
 }
 
@@ -160,6 +387,27 @@ constexpr static inline bool isKingAttacked(const BitBoard& board)
     return isKingAttacked(board, board.player);
 }
 
+/* pieces giving check to the player to move - computed from scratch
+ * NOTE: performMove keeps BitBoard::checkers up to date - this is for boards set up from scratch */
+constexpr uint64_t computeCheckers(const BitBoard& board)
+{
+    if (board.player == PlayerWhite) {
+        const uint64_t king = board.pieces[WhiteKing];
+        return king ? attackgen::getAttackers<PlayerBlack>(board, utils::lsbToPosition(king), board.occupation[Both]) : 0;
+    } else {
+        const uint64_t king = board.pieces[BlackKing];
+        return king ? attackgen::getAttackers<PlayerWhite>(board, utils::lsbToPosition(king), board.occupation[Both]) : 0;
+    }
+}
+
+/* no pieces of either side are attacked
+ * NOTE: generates the attack maps of both players - avoid in hot paths */
+constexpr static inline bool isQuietPosition(const BitBoard& board)
+{
+    return (attackgen::getAllAttacks<PlayerWhite>(board) & board.occupation[PlayerBlack]) == 0
+        && (attackgen::getAllAttacks<PlayerBlack>(board) & board.occupation[PlayerWhite]) == 0;
+}
+
 template<Player player>
 constexpr static inline BoardPosition enpessantCapturePosition(BoardPosition pos)
 {
@@ -199,8 +447,8 @@ constexpr void performEnpessantMove(BitBoard& newBoard, movegen::Move move)
     const auto toPos = move.toPos();
     const auto capturePos = enpessantCapturePosition<player>(toPos);
 
-    movePiece(newBoard.pieces[ourPawn], fromPos, toPos, ourPawn, newBoard.hash);
-    clearPiece(newBoard.pieces[theirPawn], capturePos, theirPawn, newBoard.hash);
+    movePiece(newBoard, fromPos, toPos, ourPawn);
+    clearPiece(newBoard, capturePos, theirPawn);
 
     core::hashPiece(ourPawn, fromPos, newBoard.kpHash);
     core::hashPiece(ourPawn, toPos, newBoard.kpHash);
@@ -216,7 +464,7 @@ constexpr BitBoard performMove(const BitBoard& board, movegen::Move move)
 
     const auto fromPos = move.fromPos();
     const auto toPos = move.toPos();
-    const auto pieceType = board.getAttackerAtSquare<player>(move.fromSquare()).value();
+    const auto pieceType = board.getAttackerAt<player>(fromPos).value();
 
     if (move.isCastleMove()) {
         performCastleMove<player>(newBoard, move);
@@ -226,8 +474,8 @@ constexpr BitBoard performMove(const BitBoard& board, movegen::Move move)
         performPromotionMove<player>(newBoard, move);
     } else {
         if (move.isCapture()) {
-            if (const auto victim = board.getTargetAtSquare<player>(move.toSquare())) {
-                clearPiece(newBoard.pieces[victim.value()], move.toPos(), victim.value(), newBoard.hash);
+            if (const auto victim = board.getTargetAt<player>(toPos)) {
+                clearPiece(newBoard, move.toPos(), victim.value());
 
                 if (utils::isPawn<opponent>(*victim)) {
                     core::hashPiece(*victim, toPos, newBoard.kpHash);
@@ -235,7 +483,7 @@ constexpr BitBoard performMove(const BitBoard& board, movegen::Move move)
             }
         }
 
-        movePiece(newBoard.pieces[pieceType], fromPos, toPos, pieceType, newBoard.hash);
+        movePiece(newBoard, fromPos, toPos, pieceType);
 
         if (utils::isPawn<player>(pieceType) || utils::isKing<player>(pieceType)) {
             core::hashPiece(pieceType, fromPos, newBoard.kpHash);
@@ -259,9 +507,7 @@ constexpr BitBoard performMove(const BitBoard& board, movegen::Move move)
     }
 
     newBoard.updateOccupation();
-
-    newBoard.attacks[PlayerWhite] = attackgen::getAllAttacks<PlayerWhite>(newBoard);
-    newBoard.attacks[PlayerBlack] = attackgen::getAllAttacks<PlayerBlack>(newBoard);
+    newBoard.checkers = getCheckersAfterMove<player>(newBoard, move);
 
     /* player making the move is black -> inc full moves */
     if constexpr (player == PlayerBlack)
@@ -290,6 +536,227 @@ constexpr BitBoard performMove(const BitBoard& board, movegen::Move move)
         return performMove<PlayerBlack>(board, move);
 }
 
+/* everything needed to test the legality of a move - computed once per position */
+struct LegalityInfo {
+    uint64_t king {}; /* square of our king - empty if there's no king on the board */
+    uint64_t checkers {}; /* opponent pieces giving check */
+    uint64_t pinned {}; /* our pieces pinned to our king */
+    uint64_t evasionMask {}; /* squares a non-king move must move to - all squares if not in check */
+};
+
+template<Player player>
+constexpr LegalityInfo getLegalityInfo(const BitBoard& board)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr Piece king = player == PlayerWhite ? WhiteKing : BlackKing;
+
+    LegalityInfo info { .evasionMask = ~0ULL };
+
+    if (board.pieces[king] == 0)
+        return info;
+
+    const BoardPosition kingPos = utils::lsbToPosition(board.pieces[king]);
+
+    info.king = board.pieces[king];
+    info.checkers = board.checkers;
+    info.pinned = attackgen::getSliderBlockers<opponent>(board, kingPos) & board.occupation[player];
+
+    if (std::has_single_bit(info.checkers)) {
+        /* capture the checker or block the check */
+        info.evasionMask = info.checkers | s_betweenMaskTable[kingPos][utils::lsbToPosition(info.checkers)];
+    } else if (info.checkers) {
+        /* double check - only the king can move */
+        info.evasionMask = 0;
+    }
+
+    return info;
+}
+
+/* tests if a pseudo legal move leaves our king in check - without performing the move */
+template<Player player>
+constexpr bool isLegal(const BitBoard& board, movegen::Move move, const LegalityInfo& info)
+{
+    constexpr Player opponent = nextPlayer(player);
+
+    if (move.fromSquare() & info.king) {
+        /* castling is only generated if the king doesn't pass any attacked squares */
+        if (move.isCastleMove())
+            return true;
+
+        /* the king can't hide behind itself from a slider */
+        const uint64_t occupancy = board.occupation[Both] & ~info.king;
+        return attackgen::getAttackers<opponent>(board, move.toPos(), occupancy) == 0;
+    }
+
+    /* en pessant removes two pieces from the same rank - perform it to be sure */
+    if (move.takeEnPessant()) {
+        return !isKingAttacked(performMove<player>(board, move), player);
+    }
+
+    if (!(move.toSquare() & info.evasionMask))
+        return false;
+
+    if (move.fromSquare() & info.pinned) {
+        const BoardPosition kingPos = utils::lsbToPosition(info.king);
+        return s_lineMaskTable[kingPos][move.fromPos()] & move.toSquare();
+    }
+
+    return true;
+}
+
+/* generates the legal moves only
+ * the pseudo legal moves are generated and the ones leaving our king in check are
+ * filtered out with the pin and check masks of the position */
+template<movegen::MoveType type>
+constexpr void getLegalMoves(const BitBoard& board, movegen::ValidMoves& moves)
+{
+    movegen::ValidMoves pseudoLegalMoves;
+    getAllMoves<type>(board, pseudoLegalMoves);
+
+    if (board.player == PlayerWhite) {
+        const auto info = getLegalityInfo<PlayerWhite>(board);
+        for (const auto move : pseudoLegalMoves) {
+            if (isLegal<PlayerWhite>(board, move, info)) {
+                moves.addMove(move);
+            }
+        }
+    } else {
+        const auto info = getLegalityInfo<PlayerBlack>(board);
+        for (const auto move : pseudoLegalMoves) {
+            if (isLegal<PlayerBlack>(board, move, info)) {
+                moves.addMove(move);
+            }
+        }
+    }
+}
+
+/* everything needed to test if a move gives check - computed once per position */
+struct CheckInfo {
+    uint64_t king {}; /* square of the opponent king - empty if there's no king on the board */
+    std::array<uint64_t, magic_enum::enum_count<ColorlessPiece>()> checkSquares {}; /* squares each piece type gives check from */
+    uint64_t discoverers {}; /* our pieces blocking a line from one of our sliders to the opponent king */
+};
+
+template<Player player>
+constexpr CheckInfo getCheckInfo(const BitBoard& board)
+{
+    constexpr Player opponent = nextPlayer(player);
+    constexpr Piece theirKing = player == PlayerWhite ? BlackKing : WhiteKing;
+
+    CheckInfo info {};
+
+    if (board.pieces[theirKing] == 0)
+        return info;
+
+    const BoardPosition kingPos = utils::lsbToPosition(board.pieces[theirKing]);
+    const uint64_t occupancy = board.occupation[Both];
+
+    info.king = board.pieces[theirKing];
+    info.checkSquares[Pawn] = s_pawnAttackMaskTable[opponent][kingPos];
+    info.checkSquares[Knight] = movegen::getKnightMoves(kingPos);
+    info.checkSquares[Bishop] = movegen::getBishopMoves(kingPos, occupancy);
+    info.checkSquares[Rook] = movegen::getRookMoves(kingPos, occupancy);
+    info.checkSquares[Queen] = info.checkSquares[Bishop] | info.checkSquares[Rook];
+    info.discoverers = attackgen::getSliderBlockers<player>(board, kingPos) & board.occupation[player];
+
+    return info;
+}
+
+/* tests if a legal move gives check without performing it
+ * allows pruning and reduction decisions to be made before the move is made */
+template<Player player>
+constexpr bool givesCheck(const BitBoard& board, movegen::Move move, const CheckInfo& info)
+{
+    constexpr bool isWhite = player == PlayerWhite;
+    constexpr Piece bishop = isWhite ? WhiteBishop : BlackBishop;
+    constexpr Piece rook = isWhite ? WhiteRook : BlackRook;
+    constexpr Piece queen = isWhite ? WhiteQueen : BlackQueen;
+
+    if (info.king == 0)
+        return false;
+
+    const auto piece = board.getAttackerAt<player>(move.fromPos());
+    if (!piece.has_value())
+        return false;
+
+    const BoardPosition kingPos = utils::lsbToPosition(info.king);
+    const auto colorless = static_cast<ColorlessPiece>(isWhite ? *piece : *piece - BlackPawn);
+
+    /* direct check - promotions are tested below as the pawn might block the new piece */
+    if (!move.isPromotionMove() && (info.checkSquares[colorless] & move.toSquare()))
+        return true;
+
+    /* discovered check - unless the piece stays on the line to the king */
+    if ((info.discoverers & move.fromSquare()) && !(s_lineMaskTable[kingPos][move.fromPos()] & move.toSquare()))
+        return true;
+
+    if (move.isPromotionMove()) {
+        const uint64_t occupancy = board.occupation[Both] ^ move.fromSquare();
+
+        switch (move.promotionType()) {
+        case PromotionQueen:
+            return (movegen::getRookMoves(move.toPos(), occupancy) | movegen::getBishopMoves(move.toPos(), occupancy)) & info.king;
+        case PromotionKnight:
+            return movegen::getKnightMoves(move.toPos()) & info.king;
+        case PromotionBishop:
+            return movegen::getBishopMoves(move.toPos(), occupancy) & info.king;
+        case PromotionRook:
+            return movegen::getRookMoves(move.toPos(), occupancy) & info.king;
+        case PromotionNone:
+            break;
+        }
+
+        return false;
+    }
+
+    if (move.isCastleMove()) {
+        const bool kingSide = move.getFlag() == movegen::MoveFlag::KingCastle;
+        const BoardPosition rookFrom = isWhite ? (kingSide ? H1 : A1) : (kingSide ? H8 : A8);
+        const BoardPosition rookTo = isWhite ? (kingSide ? F1 : D1) : (kingSide ? F8 : D8);
+
+        const uint64_t occupancy = board.occupation[Both]
+            ^ move.fromSquare() ^ move.toSquare()
+            ^ utils::positionToSquare(rookFrom) ^ utils::positionToSquare(rookTo);
+
+        return movegen::getRookMoves(rookTo, occupancy) & info.king;
+    }
+
+    if (move.takeEnPessant()) {
+        /* the captured pawn might have blocked one of our sliders */
+        const uint64_t occupancy = board.occupation[Both]
+            ^ move.fromSquare() ^ move.toSquare()
+            ^ enpessantCaptureSquare<player>(move.toSquare());
+        const uint64_t queens = board.pieces[queen];
+
+        return (movegen::getRookMoves(kingPos, occupancy) & (board.pieces[rook] | queens))
+            || (movegen::getBishopMoves(kingPos, occupancy) & (board.pieces[bishop] | queens));
+    }
+
+    return false;
+}
+
+// Helpers: using inside loops means redundant colour checks
+constexpr CheckInfo getCheckInfo(const BitBoard& board)
+{
+    if (board.player == PlayerWhite)
+        return getCheckInfo<PlayerWhite>(board);
+    else
+        return getCheckInfo<PlayerBlack>(board);
+}
+
+constexpr bool givesCheck(const BitBoard& board, movegen::Move move, const CheckInfo& info)
+{
+    if (board.player == PlayerWhite)
+        return givesCheck<PlayerWhite>(board, move, info);
+    else
+        return givesCheck<PlayerBlack>(board, move, info);
+}
+
+constexpr bool givesCheck(const BitBoard& board, movegen::Move move)
+{
+    return givesCheck(board, move, getCheckInfo(board));
+}
+
 constexpr void printPositionDebug(const BitBoard& board)
 {
     fmt::println("");
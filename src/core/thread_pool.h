@@ -70,6 +70,11 @@ public:
         return true;
     }
 
+    size_t size() const
+    {
+        return m_workers.size();
+    }
+
     void resize(size_t newThreadCount)
     {
         if (m_workers.size() == newThreadCount)
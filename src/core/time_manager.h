@@ -4,10 +4,15 @@
 #include "core/board_defs.h"
 #include "movegen/move_types.h"
 #include "spsa/parameters.h"
+#include "utils/thread_affinity.h"
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
 #include <optional>
+#include <stop_token>
+#include <thread>
 
 class TimeManager {
 
@@ -42,7 +47,7 @@ public:
     {
         s_startTime = std::chrono::steady_clock::now();
         setupTimeControls(board);
-        s_timedOut = false;
+        armTimer();
     }
 
     static inline void startInfinite()
@@ -50,13 +55,13 @@ public:
         s_startTime = std::chrono::steady_clock::now();
         s_softTimeLimit = Duration::max();
         s_hardTimeLimit = Duration::max();
-        s_timedOut = false;
+        armTimer();
     }
 
-    static inline void updateTimeout()
+    /* the hard time limit is handled by the timer thread - only the node limit is checked here */
+    static inline void updateNodeLimit(uint64_t nodes)
     {
-        const Duration timeSpent = std::chrono::steady_clock::now() - s_startTime;
-        if (timeSpent >= s_hardTimeLimit) {
+        if (s_nodeLimit && nodes >= *s_nodeLimit) {
             s_timedOut.store(true, std::memory_order_relaxed);
         }
     }
@@ -70,6 +75,19 @@ public:
     static inline void stop()
     {
         s_timedOut = true;
+        disarmTimer();
+    }
+
+    /* time of the hard deadline of the current search - nullopt if there is none */
+    static inline std::optional<TimePoint> getDeadline()
+    {
+        std::lock_guard lock(s_timerMutex);
+        return s_deadline;
+    }
+
+    static inline TimePoint getStartTime()
+    {
+        return s_startTime;
     }
 
     static inline auto timeElapsedMs()
@@ -86,7 +104,9 @@ public:
         s_blackMoveInc = Duration::zero();
         s_movesToGo = 0;
         s_moveTime.reset();
+        s_nodeLimit.reset();
         s_timedOut = false;
+        disarmTimer();
 
         s_previousPvMove.reset();
         s_previousPvScore.reset();
@@ -117,6 +137,17 @@ public:
         s_moveTime = std::chrono::milliseconds(time);
     }
 
+    /* NOTE: checked against the nodes of the primary searcher only */
+    static inline void setNodeLimit(uint64_t nodes)
+    {
+        s_nodeLimit = nodes;
+    }
+
+    static inline std::optional<uint64_t> getNodeLimit()
+    {
+        return s_nodeLimit;
+    }
+
     static inline void setWhiteMoveInc(uint64_t inc)
     {
         s_whiteMoveInc = std::chrono::milliseconds(inc);
@@ -179,6 +210,67 @@ public:
     }
 
 private:
+    /* the timer thread sleeps until the hard deadline and then flags the timeout
+     * searchers only check the flag so the search stops on time no matter the nps
+     * the thread is started on the first search and is reused for all later searches */
+    static inline void armTimer()
+    {
+        std::lock_guard lock(s_timerMutex);
+
+        /* reset under the lock so a deadline of a previous search can't time out this one */
+        s_timedOut = false;
+
+        if (s_hardTimeLimit >= Duration(std::chrono::hours(24 * 365))) {
+            /* infinite search - also avoids overflowing the time point */
+            s_deadline.reset();
+        } else {
+            s_deadline = s_startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(s_hardTimeLimit);
+        }
+
+        if (!s_timerThread.joinable()) {
+            s_timerThread = std::jthread([](std::stop_token stopToken) {
+                /* created by whatever thread starts the first search - which might be bound to a searcher's core */
+                utils::CpuTopology::bindCurrentThread(utils::CpuTopology::allowedCpus());
+                timerLoop(stopToken);
+            });
+        }
+
+        s_timerCv.notify_one();
+    }
+
+    static inline void disarmTimer()
+    {
+        std::lock_guard lock(s_timerMutex);
+
+        s_deadline.reset();
+        s_timerCv.notify_one();
+    }
+
+    static void timerLoop(std::stop_token stopToken)
+    {
+        std::unique_lock lock(s_timerMutex);
+
+        while (!stopToken.stop_requested()) {
+            if (!s_deadline.has_value()) {
+                s_timerCv.wait(lock, stopToken, [] { return s_deadline.has_value(); });
+                continue;
+            }
+
+            /* woken early if the deadline is moved - eg. on ponderhit or a new search */
+            const TimePoint deadline = *s_deadline;
+            if (s_timerCv.wait_until(lock, stopToken, deadline, [deadline] { return s_deadline != deadline; })) {
+                continue;
+            }
+
+            if (stopToken.stop_requested()) {
+                break;
+            }
+
+            s_timedOut.store(true, std::memory_order_relaxed);
+            s_deadline.reset();
+        }
+    }
+
     static inline void setupTimeControls(const BitBoard& board)
     {
         using namespace std::chrono;
@@ -230,6 +322,7 @@ private:
     static inline Duration s_blackTime {};
     static inline uint64_t s_movesToGo {};
     static inline std::optional<Duration> s_moveTime {};
+    static inline std::optional<uint64_t> s_nodeLimit {};
     static inline Duration s_whiteMoveInc {};
     static inline Duration s_blackMoveInc {};
 
@@ -239,6 +332,12 @@ private:
 
     static inline std::atomic_bool s_timedOut;
 
+    static inline std::mutex s_timerMutex;
+    static inline std::condition_variable_any s_timerCv;
+    static inline std::optional<TimePoint> s_deadline;
+    /* must be declared after the members it uses - it's stopped and joined before they're destroyed */
+    static inline std::jthread s_timerThread;
+
     /* stability storage - so we can compare with previous iteration */
     static inline std::optional<movegen::Move> s_previousPvMove;
     static inline std::optional<Score> s_previousPvScore;
@@ -1,28 +1,38 @@
 #pragma once
 
+#include "core/thread_pool.h"
 #include "fmt/base.h"
 #include "movegen/move_types.h"
 #include "utils/memory.h"
+#include "utils/thread_affinity.h"
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
+#include <latch>
+#include <limits>
 
 namespace core {
 
+/* TtNone is reserved for empty slots - a zeroed entry is never a valid hit */
 enum TtFlag : uint8_t {
-    TtExact = 0,
-    TtAlpha = 1,
-    TtBeta = 2,
+    TtNone = 0,
+    TtExact = 1,
+    TtAlpha = 2,
+    TtBeta = 3,
 };
 
 /* Storage for smaller (< 8 bits) types stored in TT data
- * 0b00000011 -> flag (2 bits)
- * 0b00000100 ->   pv (1 bit) */
+ * 0b00000011 ->       flag (2 bits)
+ * 0b00000100 ->         pv (1 bit)
+ * 0b11111000 -> generation (5 bits) */
 struct TtInfo {
     TtInfo() = default;
-    TtInfo(TtFlag flag, bool isPv)
+    TtInfo(TtFlag flag, bool isPv, uint8_t generation)
         : data((flag & s_flagMask)
-              | (isPv << s_pvShift))
+              | (isPv << s_pvShift)
+              | ((generation & s_generationMask) << s_generationShift))
     {
     }
 
@@ -38,12 +48,21 @@ struct TtInfo {
         return data & s_pvFlag;
     }
 
+    /* search generation the entry was last written or refreshed in */
+    inline uint8_t generation() const
+    {
+        return (data >> s_generationShift) & s_generationMask;
+    }
+
+    static constexpr inline uint8_t s_generationMask { 0b11111 };
+
 private:
     uint8_t data;
 
     static constexpr inline uint8_t s_flagMask { 0b11 };
     static constexpr inline uint8_t s_pvFlag { 0b100 };
     static constexpr inline uint8_t s_pvShift { 2 };
+    static constexpr inline uint8_t s_generationShift { 3 };
 };
 
 struct TtEntryData {
@@ -56,11 +75,23 @@ struct TtEntryData {
 
 static_assert(std::atomic<TtEntryData>::is_always_lock_free);
 
-struct TtEntry {
-    std::atomic<uint64_t> key { 0 };
-    std::atomic<TtEntryData> data;
+/* a bucket fills exactly one cache line so a probe only ever touches a single line
+ * entries are verified by the lower 16 bits of the hash, the upper bits already
+ * selected the bucket. Keys and data are stored separately to keep the data
+ * naturally aligned for lock free atomics
+ * the remaining bytes hold a 4 bit writer id per entry - only used for diagnostics */
+struct alignas(64) TtBucket {
+    static constexpr inline std::size_t s_entries { 6 };
+    static constexpr inline uint8_t s_writerBits { 4 };
+    static constexpr inline uint8_t s_writerMask { 0xf };
+
+    std::array<std::atomic<TtEntryData>, s_entries> data;
+    std::array<std::atomic<uint16_t>, s_entries> keys;
+    std::atomic<uint32_t> writers;
 };
 
+static_assert(sizeof(TtBucket) == 64);
+
 constexpr inline std::optional<Score> testEntry(const TtEntryData& entryData, uint8_t ply, uint8_t depth, Score alpha, Score beta)
 {
     if (entryData.depth < depth || entryData.score == s_noScore)
@@ -82,27 +113,46 @@ constexpr inline std::optional<Score> testEntry(const TtEntryData& entryData, ui
 class TranspositionTable {
 public:
     /* frees the memory of the current table (if any) and allocates the amount provided in MB
+     * the new table is cleared by the thread pool if provided
      * NOTE: NOT THREAD SAFE */
-    static void setSizeMb(std::size_t sizeMb)
+    static void setSizeMb(std::size_t sizeMb, ThreadPool* threadPool = nullptr)
     {
         if (sizeMb <= 0) {
             fmt::println("Invalid size: {}mb", sizeMb);
             return;
         }
 
-        if (s_tableSize > 0) {
-            utils::alignedFree(s_table);
-        }
+        utils::largePageFree(s_allocation);
 
         s_tableSize = tableSizeFromMb(sizeMb);
-        s_table = static_cast<TtEntry*>(utils::alignedAlloc(alignof(TtEntry), s_tableSize * sizeof(TtEntry)));
+        s_allocation = utils::largePageAlloc(s_tableSize * sizeof(TtBucket), s_useLargePages);
+        s_table = static_cast<TtBucket*>(s_allocation.ptr);
 
         if (s_table == nullptr) {
             fmt::println("Could not allocate memory for hash table");
             s_tableSize = 0;
         }
 
-        clear();
+        clear(threadPool);
+
+        /* the table is touched by now - check what the kernel actually backed it by */
+        s_allocation.pageType = utils::confirmedPageType(s_allocation);
+    }
+
+    /* reallocates the current table with/without large pages
+     * NOTE: NOT THREAD SAFE */
+    static void setLargePages(bool enabled, ThreadPool* threadPool = nullptr)
+    {
+        s_useLargePages = enabled;
+
+        if (s_tableSize > 0) {
+            setSizeMb(getSizeMb(), threadPool);
+        }
+    }
+
+    static utils::PageType getPageType()
+    {
+        return s_allocation.pageType;
     }
 
     /* prefetches the memory and loads it into L1 cache line */
@@ -114,15 +164,59 @@ public:
 
     static std::size_t getSizeMb()
     {
-        return (s_tableSize / 1024 / 1024) * sizeof(TtEntry);
+        return (s_tableSize * sizeof(TtBucket)) / 1024 / 1024;
     }
 
-    static void clear()
+    /* clears the table - the work is split across the thread pool if provided
+     * besides being faster for large tables, each chunk is cleared by a thread bound to
+     * its own numa node so the pages are first touched (and thereby placed) across all nodes
+     * NOTE: NOT THREAD SAFE */
+    static void clear(ThreadPool* threadPool = nullptr)
     {
-        for (size_t i = 0; i < s_tableSize; i++) {
-            s_table[i].key = 0;
-            s_table[i].data = TtEntryData();
+        const std::size_t numChunks = threadPool ? std::clamp<std::size_t>(threadPool->size(), 1, s_tableSize) : 1;
+
+        if (numChunks == 1) {
+            clearRange(0, s_tableSize);
+        } else {
+            const std::size_t chunkSize = s_tableSize / numChunks;
+            std::latch done(numChunks);
+
+            for (std::size_t i = 0; i < numChunks; i++) {
+                const std::size_t begin = i * chunkSize;
+                const std::size_t end = i == numChunks - 1 ? s_tableSize : begin + chunkSize;
+                const auto clearChunk = [&done, begin, end, node = numaNodeForChunk(i, numChunks)] {
+                    /* pool threads are reused for searching - don't leave them bound */
+                    const utils::ScopedThreadAffinity affinity(node != nullptr);
+                    if (node != nullptr) {
+                        utils::CpuTopology::bindCurrentThread(*node);
+                    }
+
+                    clearRange(begin, end);
+                    done.count_down();
+                };
+
+                /* queue is full - do the work ourselves */
+                if (!threadPool->submit(clearChunk)) {
+                    clearChunk();
+                }
+            }
+
+            done.wait();
         }
+
+        s_generation = 0;
+    }
+
+    /* should be called once before every new search
+     * entries from older generations are preferred when replacing */
+    static void newSearch()
+    {
+        s_generation = (s_generation + 1) & TtInfo::s_generationMask;
+    }
+
+    static uint8_t getGeneration()
+    {
+        return s_generation;
     }
 
     static uint16_t getHashFull()
@@ -130,46 +224,116 @@ public:
         assert(s_tableSize >= 1000);
 
         /* should be returned as permill */
-        uint16_t permill = 0;
+        uint16_t occupied = 0;
 
         /* table access is pseudo random so the most efficient way of finding
-         * the permill occupation must be accessing 1000 random entries and
-         * check if they're already written to */
+         * the permill occupation must be accessing 1000 random buckets and
+         * count the entries written to during the current search */
         for (uint16_t i = 0; i < 1000; i++) {
-            const uint64_t key = s_table[i].key.load(std::memory_order_relaxed);
+            for (size_t j = 0; j < TtBucket::s_entries; j++) {
+                const auto entryData = s_table[i].data[j].load(std::memory_order_relaxed);
 
-            if (key != 0) {
-                permill++;
+                if (entryData.info.flag() != TtNone && entryData.info.generation() == s_generation) {
+                    occupied++;
+                }
             }
         }
 
-        return permill;
+        return occupied / TtBucket::s_entries;
     }
 
     constexpr static std::optional<TtEntryData> probe(uint64_t key)
     {
         assert(s_tableSize > 0);
 
-        auto& entry = s_table[computeHashIndex(key)];
+        auto& bucket = s_table[computeHashIndex(key)];
+        const uint16_t key16 = static_cast<uint16_t>(key);
+
+        for (size_t i = 0; i < TtBucket::s_entries; i++) {
+            if (bucket.keys[i].load(std::memory_order_relaxed) != key16)
+                continue;
+
+            const auto entryData = bucket.data[i].load(std::memory_order_relaxed);
+            if (entryData.info.flag() != TtNone) {
+                return entryData;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    /* diagnostics - which searcher wrote the entries (see setTrackWriters)
+     * searchers are identified by a 4 bit id so with more than 15 threads some will share an id
+     * returns 0 if the entry is not found or the writer is unknown */
+    static uint8_t getWriter(uint64_t key)
+    {
+        assert(s_tableSize > 0);
 
-        uint64_t entryKey = entry.key.load(std::memory_order_relaxed);
-        auto entryData = entry.data.load(std::memory_order_relaxed);
+        auto& bucket = s_table[computeHashIndex(key)];
+        const uint16_t key16 = static_cast<uint16_t>(key);
 
-        if (entryKey != key) {
-            return std::nullopt;
+        for (size_t i = 0; i < TtBucket::s_entries; i++) {
+            if (bucket.keys[i].load(std::memory_order_relaxed) == key16) {
+                return (bucket.writers.load(std::memory_order_relaxed) >> (i * TtBucket::s_writerBits)) & TtBucket::s_writerMask;
+            }
         }
 
-        return entryData;
+        return 0;
+    }
+
+    static constexpr uint8_t writerIdFromIndex(std::size_t searcherIndex)
+    {
+        return (searcherIndex % TtBucket::s_writerMask) + 1;
+    }
+
+    /* NOTE: NOT THREAD SAFE - only change while not searching */
+    static void setTrackWriters(bool enabled)
+    {
+        s_trackWriters = enabled;
     }
 
-    constexpr static void writeEntry(uint64_t key, Score score, Score eval, movegen::Move move, bool ttPv, uint8_t depth, uint8_t ply, TtFlag flag)
+    static bool isTrackingWriters()
+    {
+        return s_trackWriters;
+    }
+
+    constexpr static void writeEntry(uint64_t key, Score score, Score eval, movegen::Move move, bool ttPv, uint8_t depth, uint8_t ply, TtFlag flag, uint8_t writer = 0)
     {
         assert(s_tableSize > 0);
 
-        auto& entry = s_table[computeHashIndex(key)];
-        const auto entryKey = entry.key.load(std::memory_order_relaxed);
-        const auto entryData = entry.data.load(std::memory_order_relaxed);
-        const bool sameKey = key == entryKey;
+        auto& bucket = s_table[computeHashIndex(key)];
+        const uint16_t key16 = static_cast<uint16_t>(key);
+
+        /* look for the same position first - otherwise pick the least valuable entry
+         * stale entries from previous searches lose value with every generation */
+        size_t index = 0;
+        bool sameKey = false;
+        int32_t minWorth = std::numeric_limits<int32_t>::max();
+
+        for (size_t i = 0; i < TtBucket::s_entries; i++) {
+            const auto entryData = bucket.data[i].load(std::memory_order_relaxed);
+
+            if (entryData.info.flag() == TtNone) {
+                index = i;
+                minWorth = std::numeric_limits<int32_t>::min();
+                continue;
+            }
+
+            if (bucket.keys[i].load(std::memory_order_relaxed) == key16) {
+                index = i;
+                sameKey = true;
+                break;
+            }
+
+            const int32_t worth = entryData.depth - s_ageWeight * entryAge(entryData);
+            if (worth < minWorth) {
+                index = i;
+                minWorth = worth;
+            }
+        }
+
+        auto& entry = bucket.data[index];
+        const auto entryData = entry.load(std::memory_order_relaxed);
 
         /* only update entry if a better one is found */
         if (!sameKey
@@ -184,21 +348,33 @@ public:
 
             TtEntryData newData {
                 .depth = depth,
-                .info = TtInfo(flag, ttPv),
+                .info = TtInfo(flag, ttPv, s_generation),
                 .score = scoreAbsolute(score, ply),
                 .eval = eval,
                 .move = move,
             };
 
             // Can be racy
-            entry.key.store(key, std::memory_order_relaxed);
-            entry.data.store(newData, std::memory_order_relaxed);
+            bucket.keys[index].store(key16, std::memory_order_relaxed);
+            entry.store(newData, std::memory_order_relaxed);
+
+            if (s_trackWriters) {
+                /* racy read-modify-write - good enough for diagnostics */
+                const uint8_t shift = index * TtBucket::s_writerBits;
+                const uint32_t writers = bucket.writers.load(std::memory_order_relaxed) & ~(TtBucket::s_writerMask << shift);
+                bucket.writers.store(writers | (writer << shift), std::memory_order_relaxed);
+            }
+        } else if (entryData.info.generation() != s_generation) {
+            /* entry is still useful - refresh it so it won't be considered stale */
+            auto refreshed = entryData;
+            refreshed.info = TtInfo(entryData.info.flag(), entryData.info.pv(), s_generation);
+            entry.store(refreshed, std::memory_order_relaxed);
         }
     }
 
     constexpr static std::size_t tableSizeFromMb(size_t sizeMb)
     {
-        return (sizeMb * 1024 * 1024) / sizeof(TtEntry);
+        return (sizeMb * 1024 * 1024) / sizeof(TtBucket);
     }
 
     constexpr static inline uint64_t computeHashIndex(uint64_t key)
@@ -216,7 +392,43 @@ public:
     }
 
 private:
+    /* consecutive chunks share a node - nullptr if there's only a single node to place the table on */
+    static const utils::CpuList* numaNodeForChunk(std::size_t chunk, std::size_t numChunks)
+    {
+        const auto& nodes = utils::CpuTopology::numaNodes();
+        if (nodes.size() <= 1) {
+            return nullptr;
+        }
+
+        return &nodes[chunk * nodes.size() / numChunks];
+    }
+
+    static void clearRange(std::size_t begin, std::size_t end)
+    {
+        for (size_t i = begin; i < end; i++) {
+            for (size_t j = 0; j < TtBucket::s_entries; j++) {
+                s_table[i].keys[j].store(0, std::memory_order_relaxed);
+                s_table[i].data[j].store(TtEntryData(), std::memory_order_relaxed);
+            }
+
+            s_table[i].writers.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /* number of generations since the entry was last touched */
+    constexpr static inline uint8_t entryAge(const TtEntryData& entryData)
+    {
+        return (s_generation - entryData.info.generation()) & TtInfo::s_generationMask;
+    }
+
+    /* how many plies of depth a single generation of age is worth when replacing */
+    static constexpr inline int32_t s_ageWeight { 4 };
+
     static inline std::size_t s_tableSize { 0 };
-    static inline TtEntry* s_table;
+    static inline TtBucket* s_table;
+    static inline utils::LargePageAllocation s_allocation {};
+    static inline bool s_useLargePages { true };
+    static inline uint8_t s_generation { 0 };
+    static inline bool s_trackWriters { false };
 };
 }
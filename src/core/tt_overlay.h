@@ -0,0 +1,100 @@
+#pragma once
+
+#include "core/transposition.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace core {
+
+/* private write buffer of a searcher - used by the deterministic search mode
+ *
+ * while an iteration is running the shared table is only read - all writes go to the
+ * overlay, which is probed before the shared table. Once all searchers are done the
+ * overlays are merged into the shared table in searcher order.
+ * No searcher can then observe the timing of another, so the search is reproducible
+ *
+ * direct mapped - colliding writes replace each other, which is deterministic as well */
+class TtOverlay {
+public:
+    /* rounded up to a power of two - 0 disables the overlay */
+    void resize(std::size_t entries)
+    {
+        m_entries.assign(entries ? std::bit_ceil(entries) : 0, Entry {});
+        m_mask = m_entries.empty() ? 0 : m_entries.size() - 1;
+    }
+
+    bool isEnabled() const
+    {
+        return !m_entries.empty();
+    }
+
+    std::optional<TtEntryData> probe(uint64_t key) const
+    {
+        const auto& entry = m_entries[key & m_mask];
+
+        if (entry.key == key && entry.data.info.flag() != TtNone) {
+            return entry.data;
+        }
+
+        return std::nullopt;
+    }
+
+    /* same replacement rules as the shared table for entries of the same position */
+    void writeEntry(uint64_t key, Score score, Score eval, movegen::Move move, bool ttPv, uint8_t depth, uint8_t ply, TtFlag flag)
+    {
+        auto& entry = m_entries[key & m_mask];
+        const bool sameKey = entry.key == key && entry.data.info.flag() != TtNone;
+
+        if (sameKey
+            && !entry.data.move.isNull()
+            && depth + (2 * ttPv) < entry.data.depth
+            && (flag != TtExact || entry.data.info.flag() == TtExact)) {
+            return;
+        }
+
+        if (sameKey && move.isNull()) {
+            move = entry.data.move;
+        }
+
+        entry.key = key;
+        entry.data = TtEntryData {
+            .depth = depth,
+            .info = TtInfo(flag, ttPv, TranspositionTable::getGeneration()),
+            .score = scoreAbsolute(score, ply),
+            .eval = eval,
+            .move = move,
+        };
+    }
+
+    /* writes every buffered entry to the shared table and empties the overlay
+     * NOTE: must only be called while no searcher is running */
+    void mergeInto(uint8_t writer)
+    {
+        for (auto& entry : m_entries) {
+            if (entry.data.info.flag() == TtNone) {
+                continue;
+            }
+
+            /* scores were converted when buffered - ply 0 keeps them as is */
+            const auto& data = entry.data;
+            TranspositionTable::writeEntry(entry.key, data.score, data.eval, data.move, data.info.pv(), data.depth, 0, data.info.flag(), writer);
+
+            entry = Entry {};
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t key;
+        TtEntryData data;
+    };
+
+    std::vector<Entry> m_entries;
+    std::size_t m_mask { 0 };
+};
+
+}
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* thread pool for batch workloads - perft, EPD suites etc.
+ *
+ * every worker owns a deque of jobs. Workers take their own jobs from the back (LIFO)
+ * so recently spawned - and cache hot - subtasks run first, while idle workers steal
+ * from the front (FIFO) of the other deques where the larger and older jobs are.
+ *
+ * - submission is unbounded and returns a future with the result of the job
+ * - jobs submitted from a worker go to that worker's own deque
+ * - waiting on a future with get() runs other jobs while waiting, so jobs are free
+ *   to spawn subjobs and wait for them without starving the pool
+ * - then() chains a continuation onto the result of another job - it's stored on that
+ *   job and only queued once the job has completed, so no worker waits for it
+ *
+ * NOTE: the search uses ThreadPool - it only hands out a few long running jobs */
+class WorkStealingPool {
+public:
+    using Job = std::move_only_function<void()>;
+
+private:
+    /* continuations of a job - queued by the worker completing the job */
+    struct Continuations {
+        std::mutex mutex;
+        bool completed { false };
+        std::vector<Job> jobs;
+    };
+
+public:
+    /* std::future that also carries the continuations of its job */
+    template<typename T>
+    class Future {
+    public:
+        Future() = default;
+
+        T get()
+        {
+            return m_future.get();
+        }
+
+        bool valid() const
+        {
+            return m_future.valid();
+        }
+
+        void wait() const
+        {
+            m_future.wait();
+        }
+
+        template<typename Rep, typename Period>
+        std::future_status wait_for(const std::chrono::duration<Rep, Period>& duration) const
+        {
+            return m_future.wait_for(duration);
+        }
+
+    private:
+        friend class WorkStealingPool;
+
+        Future(std::future<T> future, std::shared_ptr<Continuations> continuations)
+            : m_future(std::move(future))
+            , m_continuations(std::move(continuations))
+        {
+        }
+
+        std::future<T> m_future;
+        std::shared_ptr<Continuations> m_continuations;
+    };
+
+    explicit WorkStealingPool(std::size_t threadCount = std::max(std::thread::hardware_concurrency(), 1u))
+        : m_queues(std::max<std::size_t>(threadCount, 1))
+    {
+        m_workers.reserve(m_queues.size());
+        for (std::size_t i = 0; i < m_queues.size(); i++) {
+            m_workers.emplace_back([this, i](std::stop_token stopToken) { worker(stopToken, i); });
+        }
+    }
+
+    ~WorkStealingPool()
+    {
+        for (auto& worker : m_workers) {
+            worker.request_stop();
+        }
+
+        {
+            /* the lock ensures no worker is between checking for jobs and going to sleep */
+            std::lock_guard lock(m_sleepMutex);
+        }
+        m_sleepCv.notify_all();
+
+        /* std::jthread auto joins */
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t size() const
+    {
+        return m_workers.size();
+    }
+
+    template<typename Fn, typename... Args>
+    auto submit(Fn&& fn, Args&&... args) -> Future<std::invoke_result_t<Fn, Args...>>
+    {
+        auto [job, future] = makeTask(
+            [fn = std::forward<Fn>(fn), ... args = std::forward<Args>(args)]() mutable {
+                return std::invoke(std::move(fn), std::move(args)...);
+            });
+
+        push(std::move(job));
+
+        return std::move(future);
+    }
+
+    /* runs the continuation with the result of the future once it's ready
+     * the continuation is queued when the job of the future completes - or right away if it already has */
+    template<typename T, typename Fn>
+    auto then(Future<T> future, Fn&& fn)
+    {
+        auto continuations = std::move(future.m_continuations);
+        auto [job, result] = makeTask([future = std::move(future.m_future), fn = std::forward<Fn>(fn)]() mutable {
+            /* the job has completed by now - get() doesn't block */
+            if constexpr (std::is_void_v<T>) {
+                future.get();
+                return std::invoke(std::move(fn));
+            } else {
+                return std::invoke(std::move(fn), future.get());
+            }
+        });
+
+        {
+            std::lock_guard lock(continuations->mutex);
+            if (!continuations->completed) {
+                continuations->jobs.push_back(std::move(job));
+                return std::move(result);
+            }
+        }
+
+        push(std::move(job));
+
+        return std::move(result);
+    }
+
+    /* waits for the future while helping out with other jobs
+     * must be used instead of future.get() when waiting from inside a job */
+    template<typename T>
+    T get(Future<T>& future)
+    {
+        using namespace std::chrono_literals;
+
+        while (future.wait_for(0s) != std::future_status::ready) {
+            if (auto job = findJob(currentWorkerIndex())) {
+                (*job)();
+            } else {
+                /* the job we wait for is being run by someone else */
+                future.wait_for(50us);
+            }
+        }
+
+        return future.get();
+    }
+
+    template<typename T>
+    T get(Future<T>&& future)
+    {
+        return get(future);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    /* the job runs fn and queues the continuations added to the future in the meantime */
+    template<typename Fn>
+    auto makeTask(Fn&& fn) -> std::pair<Job, Future<std::invoke_result_t<Fn>>>
+    {
+        using Result = std::invoke_result_t<Fn>;
+
+        std::packaged_task<Result()> task(std::forward<Fn>(fn));
+        auto continuations = std::make_shared<Continuations>();
+        Future<Result> future(task.get_future(), continuations);
+
+        Job job = [this, task = std::move(task), continuations = std::move(continuations)]() mutable {
+            task();
+            complete(*continuations);
+        };
+
+        return { std::move(job), std::move(future) };
+    }
+
+    void complete(Continuations& continuations)
+    {
+        std::vector<Job> jobs;
+
+        {
+            std::lock_guard lock(continuations.mutex);
+            continuations.completed = true;
+            jobs.swap(continuations.jobs);
+        }
+
+        for (auto& job : jobs) {
+            push(std::move(job));
+        }
+    }
+
+    void push(Job job)
+    {
+        const auto workerIndex = currentWorkerIndex();
+        const std::size_t index = workerIndex.value_or(m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size());
+
+        /* counted before it's queued so the counter never drops below the amount of queued jobs */
+        m_pendingJobs.fetch_add(1, std::memory_order_release);
+
+        {
+            std::lock_guard lock(m_queues[index].mutex);
+            m_queues[index].jobs.push_back(std::move(job));
+        }
+
+        {
+            std::lock_guard lock(m_sleepMutex);
+        }
+        m_sleepCv.notify_one();
+    }
+
+    /* own jobs are taken from the back - stolen jobs from the front */
+    std::optional<Job> findJob(std::optional<std::size_t> workerIndex)
+    {
+        if (m_pendingJobs.load(std::memory_order_acquire) == 0) {
+            return std::nullopt;
+        }
+
+        if (workerIndex.has_value()) {
+            auto& queue = m_queues[*workerIndex];
+            std::lock_guard lock(queue.mutex);
+
+            if (!queue.jobs.empty()) {
+                Job job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                m_pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+
+                return job;
+            }
+        }
+
+        const std::size_t start = workerIndex.value_or(0);
+        for (std::size_t i = 1; i <= m_queues.size(); i++) {
+            auto& queue = m_queues[(start + i) % m_queues.size()];
+            std::lock_guard lock(queue.mutex);
+
+            if (!queue.jobs.empty()) {
+                Job job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                m_pendingJobs.fetch_sub(1, std::memory_order_relaxed);
+
+                return job;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void worker(std::stop_token stopToken, std::size_t index)
+    {
+        s_currentPool = this;
+        s_currentWorker = index;
+
+        while (!stopToken.stop_requested()) {
+            if (auto job = findJob(index)) {
+                (*job)();
+                continue;
+            }
+
+            std::unique_lock lock(m_sleepMutex);
+            m_sleepCv.wait(lock, stopToken, [this] { return m_pendingJobs.load(std::memory_order_acquire) > 0; });
+        }
+    }
+
+    /* only set if called from one of this pool's workers */
+    std::optional<std::size_t> currentWorkerIndex() const
+    {
+        return s_currentPool == this ? std::make_optional(s_currentWorker) : std::nullopt;
+    }
+
+    static inline thread_local const WorkStealingPool* s_currentPool { nullptr };
+    static inline thread_local std::size_t s_currentWorker { 0 };
+
+    std::vector<Queue> m_queues;
+    std::atomic<std::size_t> m_pendingJobs { 0 };
+    std::atomic<std::size_t> m_nextQueue { 0 };
+
+    std::mutex m_sleepMutex;
+    std::condition_variable_any m_sleepCv;
+
+    /* must be last - workers are stopped and joined before anything else is destroyed */
+    std::vector<std::jthread> m_workers;
+};
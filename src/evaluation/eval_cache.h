@@ -0,0 +1,54 @@
+#pragma once
+
+#include "evaluation/score.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace evaluation {
+
+/* small hash table caching the static evaluation of a position
+ * the upper 48 bits of the key and the score are packed into a single word
+ * so a probe is a single load - the lower bits are implied by the index
+ * NOTE: should not be used multi threaded - each searcher owns its own cache */
+class EvalCache {
+public:
+    EvalCache()
+    {
+        clear();
+    }
+
+    inline void write(uint64_t key, Score eval)
+    {
+        m_table[key & s_cacheMask] = (key & s_keyMask) | static_cast<uint16_t>(eval);
+    }
+
+    inline std::optional<Score> probe(uint64_t key) const
+    {
+        const uint64_t entry = m_table[key & s_cacheMask];
+        if ((entry & s_keyMask) != (key & s_keyMask)) {
+            return std::nullopt;
+        }
+
+        return static_cast<Score>(entry & ~s_keyMask);
+    }
+
+    inline void clear()
+    {
+        m_table.fill(s_emptyEntry);
+    }
+
+private:
+    constexpr static inline size_t s_cacheKeySize { 16 };
+    constexpr static inline uint64_t s_cacheMask { 0xffff };
+    constexpr static inline size_t s_cacheSize { 1 << s_cacheKeySize };
+    constexpr static inline uint64_t s_keyMask { ~0xffffULL };
+
+    /* a zeroed entry would match keys with zeroed upper bits - use a pattern that won't be hit in practice */
+    constexpr static inline uint64_t s_emptyEntry { 0xffffffffffff0000ULL | static_cast<uint16_t>(s_noScore) };
+
+    std::array<uint64_t, s_cacheSize> m_table;
+};
+
+}
@@ -8,16 +8,18 @@
 #include "interface/outputs.h"
 #include "movegen/move_types.h"
 #include "search/searcher.h"
+#include "utils/thread_affinity.h"
 
 #include "fmt/ranges.h"
 #include <atomic>
+#include <latch>
 
 #include <chrono>
 
 namespace evaluation {
 
 using search::Searcher;
-using search::SearcherResult;
+using search::SearcherPv;
 
 class Evaluator {
 public:
@@ -30,21 +32,68 @@ public:
     {
         if (size == m_searchers.size()) {
             return;
-        } else {
-            for (size_t i = m_searchers.size(); i < size; i++) {
-                m_searchers.emplace_back(Searcher::create());
-            }
         }
 
-        m_searchers.resize(size);
+        /* numa nodes are assigned based on the amount of searchers - the existing ones might move */
+        const size_t kept = m_threadBinding == utils::ThreadBinding::Numa ? 0 : std::min(size, m_searchers.size());
+
         m_threadPool.resize(size + 2);
+        createSearchers(kept, size);
+
+        for (size_t i = 0; i < m_searchers.size(); i++) {
+            m_searchers[i]->setIsPrimary(i == 0);
+            m_searchers[i]->setIndex(i);
+            m_searchers[i]->setDeterministic(m_isDeterministic);
+        }
+    }
+
+    /* reproducible multi threaded search for benches and regression tests - see iterativeDeepeningDeterministic
+     * NOTE: only reproducible with depth or node limits - 'go nodes' becomes a budget per searcher */
+    void setDeterministic(bool enabled)
+    {
+        m_isDeterministic = enabled;
 
-        bool primarySearcher = true;
         for (auto& searcher : m_searchers) {
-            searcher->setIsPrimary(std::exchange(primarySearcher, false));
+            searcher->setDeterministic(enabled);
         }
     }
 
+    bool isDeterministic() const
+    {
+        return m_isDeterministic;
+    }
+
+    /* searchers are recreated so their tables are placed according to the new binding */
+    void setThreadBinding(utils::ThreadBinding binding)
+    {
+        m_threadBinding = binding;
+
+        const size_t size = m_searchers.size();
+        m_searchers.clear();
+        resizeSearchers(size);
+    }
+
+    utils::ThreadBinding getThreadBinding() const
+    {
+        return m_threadBinding;
+    }
+
+    /* the hash table is cleared by the search threads */
+    void setHashSizeMb(std::size_t sizeMb)
+    {
+        core::TranspositionTable::setSizeMb(sizeMb, &m_threadPool);
+    }
+
+    void setLargePages(bool enabled)
+    {
+        core::TranspositionTable::setLargePages(enabled, &m_threadPool);
+    }
+
+    void clearHashTable()
+    {
+        core::TranspositionTable::clear(&m_threadPool);
+    }
+
     constexpr uint64_t getNodes() const
     {
         uint64_t totalNodes {};
@@ -54,6 +103,56 @@ public:
         return totalNodes;
     }
 
+    std::size_t getNumSearchers() const
+    {
+        return m_searchers.size();
+    }
+
+    /* depth and selective depth reached by the primary searcher in the latest search */
+    uint8_t getDepth() const
+    {
+        return m_searchers.front()->getReport().depth;
+    }
+
+    uint8_t getSelDepth() const
+    {
+        return m_searchers.front()->getSelDepth();
+    }
+
+    /* when the latest search unwound - the primary returns first, then the helpers are joined */
+    struct SearchTimestamps {
+        TimePoint primaryDone;
+        TimePoint helpersDone;
+    };
+
+    SearchTimestamps getSearchTimestamps() const
+    {
+        return m_searchTimestamps;
+    }
+
+    /* amount of searches started - counted once the search state has been reset
+     * a stop issued before that would be overwritten by the search starting */
+    uint64_t getSearchesStarted() const
+    {
+        return m_searchesStarted.load(std::memory_order_acquire);
+    }
+
+    /* blocks until a search has been started since 'previous' was read */
+    void waitForSearchStarted(uint64_t previous) const
+    {
+        m_searchesStarted.wait(previous, std::memory_order_acquire);
+    }
+
+    std::vector<search::SearcherStats> getSearcherStats() const
+    {
+        std::vector<search::SearcherStats> stats;
+        for (const auto& searcher : m_searchers) {
+            stats.push_back(searcher->getStats());
+        }
+
+        return stats;
+    }
+
     constexpr uint64_t getTbHits() const
     {
         uint64_t totalTbHits {};
@@ -82,6 +181,8 @@ public:
             TimeManager::start(board);
         }
 
+        core::TranspositionTable::newSearch();
+
         return startIterativeDeepening(depthInput.value_or(s_maxSearchDepth), board);
     }
 
@@ -177,10 +278,13 @@ public:
     }
 
 private:
+    /* only the primary searcher is considered - helpers are still searching
+     * and their tables might be updated while reading */
     constexpr double pvMoveNodeFraction(movegen::Move pvMove)
     {
-        const uint64_t totalNodes = getNodes();
-        const uint64_t pvNodes = getHistoryNodes(pvMove);
+        const auto& primarySearcher = m_searchers.front();
+        const uint64_t totalNodes = primarySearcher->getNodes();
+        const uint64_t pvNodes = primarySearcher->getHistoryNodes(pvMove);
 
         if (totalNodes <= 0) {
             return 1.0;
@@ -189,13 +293,67 @@ private:
         return static_cast<double>(pvNodes) / totalNodes;
     }
 
+    /* searchers [first, size) are constructed by pool threads bound to the cpus the searcher
+     * will run on - the searcher tables are then first touched, and placed, on its own numa node */
+    void createSearchers(size_t first, size_t size)
+    {
+        m_searchers.resize(size);
+        std::latch created(size - first);
+
+        for (size_t i = first; i < size; i++) {
+            const auto job = [this, i, &created] {
+                const utils::ScopedThreadAffinity affinity(isBindingThreads());
+                bindSearcherThread(i);
+                m_searchers[i] = Searcher::create();
+                created.count_down();
+            };
+
+            /* queue is full - create it ourselves */
+            if (!m_threadPool.submit(job)) {
+                job();
+            }
+        }
+
+        created.wait();
+    }
+
+    bool isBindingThreads() const
+    {
+        return m_threadBinding != utils::ThreadBinding::None;
+    }
+
+    /* pool threads aren't tied to a searcher - the thread running a searcher binds itself first
+     * NOTE: every job binding a thread must restore its affinity - see ScopedThreadAffinity */
+    void bindSearcherThread(size_t index) const
+    {
+        if (isBindingThreads()) {
+            utils::CpuTopology::bindCurrentThread(utils::CpuTopology::cpusForSearcher(m_threadBinding, index, m_searchers.size()));
+        }
+    }
+
     constexpr movegen::Move startIterativeDeepening(uint8_t depth, const BitBoard& board)
     {
-        const movegen::Move bestMove = m_searchers.size() == 1
-            ? iterativeDeepeningSingle(depth, board)
-            : iterativeDeepeningMulti(depth, board);
+        Searcher::setSearchStopped(false);
+
+        m_searchesStarted.fetch_add(1, std::memory_order_release);
+        m_searchesStarted.notify_all();
+
+        /* the primary searcher runs on the calling thread - eg. the uci thread for bench */
+        const utils::ScopedThreadAffinity affinity(isBindingThreads());
+        bindSearcherThread(0);
+
+        movegen::Move bestMove;
+        if (m_isDeterministic) {
+            bestMove = iterativeDeepeningDeterministic(depth, board);
+        } else {
+            startHelpers(depth, board);
+            bestMove = iterativeDeepening(depth, board);
+        }
+        m_searchTimestamps.primaryDone = std::chrono::steady_clock::now();
 
         stop();
+        waitForHelpers();
+        m_searchTimestamps.helpersDone = std::chrono::steady_clock::now();
 
         return bestMove;
     }
@@ -253,10 +411,39 @@ private:
         }
     };
 
-    constexpr movegen::Move iterativeDeepeningSingle(uint8_t depth, const BitBoard& board)
+    /* runs a single iteration with aspiration windows around the previous score
+     * returns nullopt if the search was stopped before the iteration completed */
+    static std::optional<Score> aspirationSearch(Searcher& searcher, uint8_t depth, const BitBoard& board, Score prevScore)
     {
-        const auto& singleSearcher = m_searchers.front();
-        Score bestScore = 0;
+        AspirationWindow window(depth, prevScore);
+
+        while (true) {
+            const auto score = searcher.startSearch(window.searchDepth(), board, window.alpha, window.beta);
+
+            if (TimeManager::hasTimedOut() || searcher.isOutOfNodes()) {
+                return std::nullopt;
+            }
+
+            if (score <= window.alpha) {
+                window.widenOnFailLow();
+            } else if (score >= window.beta) {
+                window.widenOnFailHigh();
+            } else {
+                return score;
+            }
+
+            window.grow();
+        }
+    }
+
+    /* the primary searcher drives the search: it handles time management and reporting
+     * helpers are never waited on - their latest results are picked up from their mailbox */
+    constexpr movegen::Move iterativeDeepening(uint8_t depth, const BitBoard& board)
+    {
+        const auto& primarySearcher = m_searchers.front();
+        primarySearcher->clearReport();
+
+        Score prevScore = 0;
         movegen::Move bestMove;
 
         for (uint8_t d = 1; d <= depth; d++) {
@@ -264,150 +451,217 @@ private:
                 break;
             }
 
-            AspirationWindow window(d, bestScore);
-
-            while (true) {
-                Searcher::setSearchStopped(false);
-
-                const auto score = singleSearcher->startSearch(window.searchDepth(), board, window.alpha, window.beta);
+            const auto score = aspirationSearch(*primarySearcher, d, board, prevScore);
+            if (!score.has_value()) {
+                break;
+            }
 
-                if (TimeManager::hasTimedOut()) {
-                    break;
-                }
+            prevScore = *score;
+            primarySearcher->publishReport(d, *score);
 
-                if (score <= window.alpha) {
-                    window.widenOnFailLow();
-                } else if (score >= window.beta) {
-                    window.widenOnFailHigh();
-                } else {
-                    bestScore = score;
-                    interface::printSearchInfo(singleSearcher, score, d, getNodes(), getTbHits());
-                    bestMove = singleSearcher->getPvMove();
-                    m_ponderMove = singleSearcher->getPonderMove();
-                    TimeManager::updateMoveStability(bestMove, score, pvMoveNodeFraction(bestMove));
-
-                    break;
-                }
+            /* the line of the searcher that won the vote - printed pv always starts with the best move */
+            const auto pv = m_searchers.size() == 1 ? primarySearcher->getPv() : voteBestPv();
+            const auto& report = pv.report;
 
-                window.grow();
-            }
+            interface::printSearchInfo(pv, getNodes(), getTbHits());
+            bestMove = report.pvMove;
+            m_ponderMove = report.ponderMove.isNull() ? std::nullopt : std::make_optional(report.ponderMove);
+            TimeManager::updateMoveStability(bestMove, report.score, pvMoveNodeFraction(bestMove));
         }
 
         return bestMove;
     }
 
-    /* currently using a more primitive iterative deepening with fixed window search
-     * update to use similar implementation as single threaded search */
-    constexpr movegen::Move iterativeDeepeningMulti(uint8_t depth, const BitBoard& board)
+    /* all searchers run each iteration in lockstep - every other helper one ply deeper for diversity
+     * the shared TT is read only while an iteration runs, writes are buffered per searcher and merged
+     * in searcher order once all are done. Searchers stop on their own node budget instead of being
+     * stopped by each other, so the result only depends on the position, the limits and the thread count */
+    constexpr movegen::Move iterativeDeepeningDeterministic(uint8_t depth, const BitBoard& board)
     {
+        const auto& primarySearcher = m_searchers.front();
+        const uint64_t nodeBudget = TimeManager::getNodeLimit().value_or(0);
+
+        std::vector<Score> prevScores(m_searchers.size(), 0);
+        std::vector<uint8_t> isActive(m_searchers.size(), true);
+
+        for (const auto& searcher : m_searchers) {
+            searcher->clearReport();
+            searcher->setNodeBudget(nodeBudget);
+        }
+
+        const auto searchIteration = [&](size_t index, uint8_t d) {
+            const auto& searcher = m_searchers[index];
+            const uint8_t searchDepth = std::min<uint8_t>(d + (index & 1), depth);
+
+            const auto score = aspirationSearch(*searcher, searchDepth, board, prevScores[index]);
+            if (!score.has_value()) {
+                isActive[index] = false;
+                return;
+            }
+
+            prevScores[index] = *score;
+            searcher->publishReport(searchDepth, *score);
+            isActive[index] = !searcher->isOutOfNodes();
+        };
+
         movegen::Move bestMove;
-        uint8_t d = 1;
-        Score alpha = s_minScore;
-        Score beta = s_maxScore;
 
-        while (d <= depth) {
+        for (uint8_t d = 1; d <= depth; d++) {
             if (!TimeManager::timeForAnotherSearch(d)) {
                 break;
             }
 
-            Searcher::setSearchStopped(false);
+            std::latch helpersDone(m_searchers.size() - 1);
+            for (size_t i = 1; i < m_searchers.size(); i++) {
+                const auto job = [this, i, d, &isActive, &searchIteration, &helpersDone] {
+                    if (isActive[i]) {
+                        const utils::ScopedThreadAffinity affinity(isBindingThreads());
+                        bindSearcherThread(i);
+                        searchIteration(i, d);
+                    }
+                    helpersDone.count_down();
+                };
 
-            /* Thread voting: https://www.chessprogramming.org/Lazy_SMP */
-            std::array<SearcherResult, s_maxThreads> searchResults {};
-            uint8_t numSearchResults {};
+                /* queue is full - search it ourselves */
+                if (!m_threadPool.submit(job)) {
+                    job();
+                }
+            }
 
-            for (auto& searcher : m_searchers) {
-                searcher->startSearchAsync(m_threadPool, d, board, alpha, beta);
+            if (isActive.front()) {
+                searchIteration(0, d);
             }
 
-            for (auto& searcher : m_searchers) {
-                const auto& result = searcher->getSearchResult();
-                if (result.has_value()) {
-                    // If didn't fall out of window and wasn't an immediate early termination, push back to results
-                    if ((result.value().score > alpha) && (result.value().score < beta) && result.value().searchedDepth > 0) {
-                        searchResults.at(numSearchResults) = result.value();
-                        ++numSearchResults;
-                    }
-                }
+            helpersDone.wait();
+
+            for (const auto& searcher : m_searchers) {
+                searcher->mergeTtOverlay();
             }
 
-            /* use previous search if we timed out - it means that the current search was incomplete */
-            if (TimeManager::hasTimedOut()) {
+            const auto pv = m_searchers.size() == 1 ? primarySearcher->getPv() : voteBestPv();
+            const auto& report = pv.report;
+            if (report.depth > 0) {
+                interface::printSearchInfo(pv, getNodes(), getTbHits());
+                bestMove = report.pvMove;
+                m_ponderMove = report.ponderMove.isNull() ? std::nullopt : std::make_optional(report.ponderMove);
+                TimeManager::updateMoveStability(bestMove, report.score, pvMoveNodeFraction(bestMove));
+            }
+
+            if (std::ranges::none_of(isActive, [](uint8_t active) { return active; }) || TimeManager::hasTimedOut()) {
                 break;
             }
+        }
 
-            if (numSearchResults == 0) {
-                alpha = s_minScore;
-                beta = s_maxScore;
+        return bestMove;
+    }
 
-                continue;
+    /* helpers run their own iterative deepening loop until the search is stopped
+     * each completed iteration is published so the primary searcher can vote on it */
+    static void iterativeDeepeningHelper(Searcher& searcher, uint8_t depth, const BitBoard& board)
+    {
+        Score prevScore = 0;
+
+        for (uint8_t d = 1; d <= depth; d++) {
+            const auto score = aspirationSearch(searcher, d, board, prevScore);
+            if (!score.has_value()) {
+                break;
             }
 
-            m_movesVotes.clear();
+            prevScore = *score;
+            searcher.publishReport(d, *score);
+        }
+    }
 
-            for (uint8_t i = 0; i < numSearchResults; i++) {
+    void startHelpers(uint8_t depth, const BitBoard& board)
+    {
+        for (size_t i = 1; i < m_searchers.size(); i++) {
+            const auto& searcher = m_searchers[i];
+            searcher->clearReport();
 
-                const auto& result = searchResults.at(i);
+            m_activeHelpers.fetch_add(1, std::memory_order_relaxed);
 
-                const Score score = result.score;
-                const uint8_t depth = result.searchedDepth;
-                const auto move = result.pvMove;
+            [[maybe_unused]] const bool started = m_threadPool.submit([this, searcher, i, depth, board] {
+                {
+                    const utils::ScopedThreadAffinity affinity(isBindingThreads());
+                    bindSearcherThread(i);
+                    iterativeDeepeningHelper(*searcher, depth, board);
+                }
 
-                /* Can be tweaked for optimization */
-                int64_t voteWeight = (score - s_minScore) * depth;
+                m_activeHelpers.fetch_sub(1, std::memory_order_release);
+                m_activeHelpers.notify_all();
+            });
 
-                m_movesVotes.insertOrIncrement(move, voteWeight);
-            }
+            assert(started);
+        }
+    }
 
-            int64_t maxVote = -std::numeric_limits<int64_t>::max();
+    /* searchers are reused between searches so ensure that all helpers have exited */
+    void waitForHelpers()
+    {
+        size_t active = m_activeHelpers.load(std::memory_order_acquire);
+        while (active > 0) {
+            m_activeHelpers.wait(active, std::memory_order_acquire);
+            active = m_activeHelpers.load(std::memory_order_acquire);
+        }
+    }
 
-            for (const auto& [move, vote] : m_movesVotes) {
-                if (vote > maxVote) {
-                    maxVote = vote;
-                    bestMove = move;
-                }
-            }
+    /* Thread voting: https://www.chessprogramming.org/Lazy_SMP
+     * reports can be from different depths - deeper and better scoring results weigh more
+     * the winning line is returned as a whole so its move, score and pv all come from the same searcher */
+    SearcherPv voteBestPv()
+    {
+        std::vector<SearcherPv> pvs;
+        pvs.reserve(m_searchers.size());
 
-            uint8_t bestWinningDepth = 0;
-            SearcherResult bestWinningResult;
+        m_movesVotes.clear();
 
-            for (uint8_t i = 0; i < numSearchResults; i++) {
-                if (searchResults.at(i).pvMove == bestMove) {
-                    if (depth > bestWinningDepth) {
-                        bestWinningResult = searchResults.at(i);
-                        bestWinningDepth = depth;
-                    }
-                }
+        for (const auto& searcher : m_searchers) {
+            const auto pv = searcher->getPv();
+            if (pv.report.depth == 0) {
+                continue;
             }
 
-            /* prepare window for next iteration */
-            alpha = bestWinningResult.score - spsa::aspirationWindow;
-            beta = bestWinningResult.score + spsa::aspirationWindow;
+            /* Can be tweaked for optimization */
+            const int64_t voteWeight = (pv.report.score - s_minScore) * pv.report.depth;
+            m_movesVotes.insertOrIncrement(pv.report.pvMove, voteWeight);
 
-            const auto searcher = bestWinningResult.searcher.lock();
-            if (!searcher) {
-                /* should not happen during a search - have we been stopped? */
-                break;
-            }
+            pvs.push_back(pv);
+        }
 
-            interface::printSearchInfo(searcher, bestWinningResult.score, d, getNodes(), getTbHits());
-            m_ponderMove = searcher->getPonderMove();
+        movegen::Move bestMove {};
+        int64_t maxVote = -std::numeric_limits<int64_t>::max();
 
-            TimeManager::updateMoveStability(bestMove, bestWinningResult.score, pvMoveNodeFraction(bestMove));
+        for (const auto& [move, vote] : m_movesVotes) {
+            if (vote > maxVote) {
+                maxVote = vote;
+                bestMove = move;
+            }
+        }
 
-            d++;
+        /* the deepest line backing the winning move */
+        SearcherPv bestPv {};
+        for (const auto& pv : pvs) {
+            if (pv.report.pvMove == bestMove && pv.report.depth > bestPv.report.depth) {
+                bestPv = pv;
+            }
         }
 
-        return bestMove;
+        return bestPv;
     }
 
     std::atomic_bool m_killed { false };
+    std::atomic_size_t m_activeHelpers { 0 };
+    std::atomic_uint64_t m_searchesStarted { 0 };
 
     ThreadPool m_threadPool { 3 }; /* Iterative deepening, time handler, default=1 searcher */
 
     std::vector<std::shared_ptr<Searcher>> m_searchers {};
+    utils::ThreadBinding m_threadBinding { utils::ThreadBinding::None };
     MoveVoteMap<s_maxThreads> m_movesVotes {};
 
+    SearchTimestamps m_searchTimestamps {};
+
+    bool m_isDeterministic { false };
     bool m_isPondering { false };
     bool m_ponderingEnabled { false };
     std::optional<movegen::Move> m_ponderMove {};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/bit_board.h"
+#include "evaluation/generated/tuned_terms.h"
+#include "utils/bit_operations.h"
+
+#include <array>
+
+namespace evaluation {
+
+namespace {
+
+constexpr TermScore getPsqtTerm(ColorlessPiece piece, BoardPosition pos)
+{
+    switch (piece) {
+    case Pawn:
+        return s_terms.psqtPawns[pos];
+    case Knight:
+        return s_terms.psqtKnights[pos];
+    case Bishop:
+        return s_terms.psqtBishops[pos];
+    case Rook:
+        return s_terms.psqtRooks[pos];
+    case Queen:
+        return s_terms.psqtQueens[pos];
+    case King:
+        return s_terms.psqtKings[pos];
+    }
+
+    return TermScore(0, 0);
+}
+
+}
+
+/* material + psqt score of every piece on every square
+ * scores are seen from white - black pieces are mirrored and negated so
+ * the board accumulator can simply add and subtract entries as pieces move */
+constexpr auto s_psqtTable = [] {
+    std::array<std::array<TermScore, s_amountSquares>, s_amountPieces> table {};
+
+    for (uint8_t pos = 0; pos < s_amountSquares; pos++) {
+        const auto square = intToBoardPosition(pos);
+
+        for (const auto piece : s_whitePieces) {
+            const auto colorless = static_cast<ColorlessPiece>(piece);
+            table[piece][square] = s_terms.pieceValues[colorless] + getPsqtTerm(colorless, square);
+        }
+
+        for (const auto piece : s_blackPieces) {
+            const auto colorless = static_cast<ColorlessPiece>(piece - BlackPawn);
+            table[piece][square] = TermScore(0, 0) - (s_terms.pieceValues[colorless] + getPsqtTerm(colorless, utils::flipPosition(square)));
+        }
+    }
+
+    return table;
+}();
+
+/* computes the full material + psqt score from scratch
+ * performMove keeps it updated incrementally so this is only needed when setting up a board */
+constexpr TermScore computePsqtScore(const BitBoard& board)
+{
+    TermScore score(0, 0);
+
+    for (uint8_t piece = 0; piece < s_amountPieces; piece++) {
+        utils::bitIterate(board.pieces[piece], [&](BoardPosition pos) {
+            score += s_psqtTable[piece][pos];
+        });
+    }
+
+    return score;
+}
+
+constexpr uint8_t computePhase(const BitBoard& board)
+{
+    uint8_t phase = 0;
+
+    for (uint8_t piece = 0; piece < s_amountPieces; piece++) {
+        phase += std::popcount(board.pieces[piece]) * s_piecePhaseValues[piece];
+    }
+
+    return phase;
+}
+
+}
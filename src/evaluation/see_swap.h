@@ -38,7 +38,7 @@ public:
         /* piece that will track the scoring of next piece */
         Piece nextPiece = promotionPiece.has_value()
             ? static_cast<Piece>(promotionPiece.value())
-            : board.getAttackerAtSquare(fromSquare, board.player).value();
+            : board.getAttackerAt(move.fromPos(), board.player).value();
 
         /* remove our current move's piece - it's "assumed" to already have been moved to the target square */
         uint64_t occ = (board.occupation[Both] & ~fromSquare) | toSquare;
@@ -47,8 +47,8 @@ public:
             occ &= ~core::enpessantCaptureSquare(toSquare, board.player);
             balance += s_pieceValues[Pawn];
         } else if (move.isCapture()) {
-            const Piece target = board.getTargetAtSquare(toSquare, board.player).value();
-            balance += s_pieceValues[target];
+            const Piece victim = board.getTargetAt(target, board.player).value();
+            balance += s_pieceValues[victim];
         }
 
         if (promotionPiece.has_value()) {
@@ -108,7 +108,7 @@ public:
         /* piece that will track the scoring of next piece */
         Piece nextPiece = promotionPiece.has_value()
             ? static_cast<Piece>(promotionPiece.value())
-            : board.getAttackerAtSquare(fromSquare, board.player).value();
+            : board.getAttackerAt(move.fromPos(), board.player).value();
 
         /* remove our current move's piece - it's "assumed" to already have been moved to the target square */
         uint64_t occ = (board.occupation[Both] & ~fromSquare) | toSquare;
@@ -118,7 +118,7 @@ public:
             gain[depth] = s_pieceValues[Pawn];
             occ &= ~core::enpessantCaptureSquare(toSquare, player);
         } else {
-            const auto initialPiece = board.getTargetAtSquare(toSquare, player).value();
+            const auto initialPiece = board.getTargetAt(target, player).value();
             gain[depth] = s_pieceValues[initialPiece];
         }
 
@@ -31,9 +31,14 @@ public:
     {
         TermScore score(0, 0);
 
-        m_phase = 0;
+        m_phase = board.phase;
         auto ctx = prepareContext(board);
 
+#ifndef TUNING
+        /* material and psqt are updated incrementally when performing moves */
+        score += board.psqtScore;
+#endif
+
         /* terms that are not using ctx */
         APPLY_SCORE(getTempoScore, board);
 
@@ -45,10 +50,10 @@ public:
 #endif
 
         /* piece scores - should be computed first as they populate ctx */
-        APPLY_SCORE(getKnightScore, board, ctx, m_phase);
-        APPLY_SCORE(getBishopScore, board, ctx, m_phase);
-        APPLY_SCORE(getRookScore, board, ctx, m_phase);
-        APPLY_SCORE(getQueenScore, board, ctx, m_phase);
+        APPLY_SCORE(getKnightScore, board, ctx);
+        APPLY_SCORE(getBishopScore, board, ctx);
+        APPLY_SCORE(getRookScore, board, ctx);
+        APPLY_SCORE(getQueenScore, board, ctx);
         APPLY_SCORE(getKingScore, board, ctx);
 
         /* terms that consume ctx */
@@ -49,6 +49,14 @@
 
 #endif
 
+/* material and psqt scores are accumulated incrementally in BitBoard::psqtScore
+ * the tuner still needs them added per term so the weights are traced */
+#ifdef TUNING
+#define ADD_PSQT_SCORE_INDEXED(weightName, index) ADD_SCORE_INDEXED(weightName, index)
+#else
+#define ADD_PSQT_SCORE_INDEXED(weightName, index)
+#endif
+
 /* helper for single index tables */
 #define ADD_SCORE(weightName) ADD_SCORE_INDEXED(weightName, 0)
 #define ADD_SCORE_MULTI(weightName, multi) ADD_SCORE_MULTI_INDEXED(weightName, multi, 0)
@@ -123,7 +131,7 @@ static inline TermScore getStaticKingPawnScore(const BitBoard& board, TermContex
     const auto theirKingPos = utils::lsbToPosition(board.pieces[theirKing]);
 
     /* add psqt king score here as it's the only static king score */
-    ADD_SCORE_INDEXED(psqtKings, utils::relativePosition<player>(ourKingPos));
+    ADD_PSQT_SCORE_INDEXED(psqtKings, utils::relativePosition<player>(ourKingPos));
 
     /* add score if our king attacks one or more of their pawns */
     if (ctx.kingZone[player] & theirPawns) {
@@ -134,8 +142,8 @@ static inline TermScore getStaticKingPawnScore(const BitBoard& board, TermContex
         const uint64_t square = utils::positionToSquare(pos);
         const auto row = utils::relativeRow<player>(pos);
 
-        ADD_SCORE_INDEXED(pieceValues, Pawn);
-        ADD_SCORE_INDEXED(psqtPawns, utils::relativePosition<player>(pos));
+        ADD_PSQT_SCORE_INDEXED(pieceValues, Pawn);
+        ADD_PSQT_SCORE_INDEXED(psqtPawns, utils::relativePosition<player>(pos));
 
         const auto doubledPawns = std::popcount(ourPawns & core::s_fileMaskTable[pos]);
         if (doubledPawns > 1)
@@ -208,7 +216,7 @@ static inline TermScore getStaticKingPawnScore(const BitBoard& board, TermContex
 }
 
 template<Player player>
-static inline TermScore getKnightScore(const BitBoard& board, TermContext& ctx, uint8_t& phaseScore)
+static inline TermScore getKnightScore(const BitBoard& board, TermContext& ctx)
 {
     TermScore score(0, 0);
 
@@ -233,9 +241,8 @@ static inline TermScore getKnightScore(const BitBoard& board, TermContext& ctx,
         const uint64_t moves = movegen::getKnightMoves(pos) & ~board.occupation[player];
         const uint64_t square = utils::positionToSquare(pos);
 
-        phaseScore += s_piecePhaseValues[Knight];
-        ADD_SCORE_INDEXED(pieceValues, Knight);
-        ADD_SCORE_INDEXED(psqtKnights, utils::relativePosition<player>(pos));
+        ADD_PSQT_SCORE_INDEXED(pieceValues, Knight);
+        ADD_PSQT_SCORE_INDEXED(psqtKnights, utils::relativePosition<player>(pos));
 
         /* update mobility score based on possible moves that are not attacked by their pawns */
         const int mobilityCount = std::popcount(moves & ~theirPawnAttacks);
@@ -258,7 +265,7 @@ static inline TermScore getKnightScore(const BitBoard& board, TermContext& ctx,
 }
 
 template<Player player>
-static inline TermScore getBishopScore(const BitBoard& board, TermContext& ctx, uint8_t& phaseScore)
+static inline TermScore getBishopScore(const BitBoard& board, TermContext& ctx)
 {
     TermScore score(0, 0);
 
@@ -287,9 +294,8 @@ static inline TermScore getBishopScore(const BitBoard& board, TermContext& ctx,
         const uint64_t moves = movegen::getBishopMoves(pos, board.occupation[Both]) & ~board.occupation[player];
         const uint64_t square = utils::positionToSquare(pos);
 
-        phaseScore += s_piecePhaseValues[Bishop];
-        ADD_SCORE_INDEXED(pieceValues, Bishop);
-        ADD_SCORE_INDEXED(psqtBishops, utils::relativePosition<player>(pos));
+        ADD_PSQT_SCORE_INDEXED(pieceValues, Bishop);
+        ADD_PSQT_SCORE_INDEXED(psqtBishops, utils::relativePosition<player>(pos));
 
         /* update mobility score based on possible moves that are not attacked by their pawns */
         const int mobilityCount = std::popcount(moves & ~theirPawnAttacks);
@@ -321,7 +327,7 @@ static inline TermScore getBishopScore(const BitBoard& board, TermContext& ctx,
 }
 
 template<Player player>
-static inline TermScore getRookScore(const BitBoard& board, TermContext& ctx, uint8_t& phaseScore)
+static inline TermScore getRookScore(const BitBoard& board, TermContext& ctx)
 {
     TermScore score(0, 0);
 
@@ -344,9 +350,8 @@ static inline TermScore getRookScore(const BitBoard& board, TermContext& ctx, ui
         const uint64_t square = utils::positionToSquare(pos);
         const uint64_t moves = movegen::getRookMoves(pos, board.occupation[Both]) & ~board.occupation[player];
 
-        phaseScore += s_piecePhaseValues[Rook];
-        ADD_SCORE_INDEXED(pieceValues, Rook);
-        ADD_SCORE_INDEXED(psqtRooks, utils::relativePosition<player>(pos));
+        ADD_PSQT_SCORE_INDEXED(pieceValues, Rook);
+        ADD_PSQT_SCORE_INDEXED(psqtRooks, utils::relativePosition<player>(pos));
 
         /* update mobility score based on possible moves that are not attacked by their pawns */
         const int mobilityCount = std::popcount(moves & ~theirPawnAttacks);
@@ -374,7 +379,7 @@ static inline TermScore getRookScore(const BitBoard& board, TermContext& ctx, ui
 }
 
 template<Player player>
-static inline TermScore getQueenScore(const BitBoard& board, TermContext& ctx, uint8_t& phaseScore)
+static inline TermScore getQueenScore(const BitBoard& board, TermContext& ctx)
 {
     TermScore score(0, 0);
 
@@ -394,9 +399,8 @@ static inline TermScore getQueenScore(const BitBoard& board, TermContext& ctx, u
             = (movegen::getBishopMoves(pos, board.occupation[Both]) | movegen::getRookMoves(pos, board.occupation[Both]))
             & ~board.occupation[player];
 
-        phaseScore += s_piecePhaseValues[Queen];
-        ADD_SCORE_INDEXED(pieceValues, Queen);
-        ADD_SCORE_INDEXED(psqtQueens, utils::relativePosition<player>(pos));
+        ADD_PSQT_SCORE_INDEXED(pieceValues, Queen);
+        ADD_PSQT_SCORE_INDEXED(psqtQueens, utils::relativePosition<player>(pos));
 
         if (((ourPawns | theirPawns) & core::s_fileMaskTable[pos]) == 0)
             ADD_SCORE(queenOpenFileBonus);
@@ -570,8 +574,7 @@ static inline TermScore getPawnPushThreatScore(const BitBoard& board, TermContex
     /* iterate each attack and assign a bonus based on what type of piece we're attacking if pushed
      * ie pawn push threats -> pawns that can be pushed and cause a "safe" attack towards a non-pawn piece */
     utils::bitIterate(attacks, [&](BoardPosition pos) {
-        const uint64_t square = utils::positionToSquare(pos);
-        const auto target = board.getTargetAtSquare<player>(square);
+        const auto target = board.getTargetAt<player>(pos);
         const auto colorlessPiece = pieceToColorlessPiece<opponent>(*target);
         ADD_SCORE_INDEXED(pawnPushThreats, colorlessPiece);
     });
@@ -2,12 +2,16 @@
 
 #include "core/bit_board.h"
 #include "core/time_manager.h"
+#include "magics/magics.h"
+#include "nnue/simd.h"
 #include "search/searcher.h"
+#include "utils/cpu_features.h"
 #include "version.h"
 
 #include <fmt/color.h>
 
 #include <memory>
+#include <string>
 
 #ifdef _WIN32
 /* FIXME: for now disable pretty print for windows builds */
@@ -20,26 +24,27 @@ static const bool s_prettyPrintSupported = isatty(fileno(stdout)) != 0;
 namespace {
 
 static inline bool s_isPrettyPrintEnabled = s_prettyPrintSupported;
+static inline bool s_isSearchInfoEnabled = true;
 
-inline void printSearchInfoUci(std::shared_ptr<search::Searcher> searcher, Score score, uint8_t currentDepth, uint64_t nodes, uint64_t tbHits)
+inline void printSearchInfoUci(const search::SearcherPv& pv, uint64_t nodes, uint64_t tbHits)
 {
     const auto timeDiff = TimeManager::timeElapsedMs().count();
     const uint16_t hashFull = core::TranspositionTable::getHashFull();
 
     fmt::print("info score {} time {} depth {} seldepth {} nodes {} hashfull {}{}{} pv ",
-        ScorePrint(score),
+        ScorePrint(pv.report.score),
         timeDiff,
-        currentDepth,
-        searcher->getSelDepth(),
+        pv.report.depth,
+        pv.selDepth,
         nodes,
         hashFull,
         NpsPrint(nodes, timeDiff),
         TbHitPrint(tbHits));
 
-    fmt::println("{}", fmt::join(searcher->getPvTable(), " "));
+    fmt::println("{}", fmt::join(pv, " "));
 }
 
-inline void printSearchInfoPretty(std::shared_ptr<search::Searcher> searcher, Score score, uint8_t currentDepth, uint64_t nodes, uint64_t tbHits)
+inline void printSearchInfoPretty(const search::SearcherPv& pv, uint64_t nodes, uint64_t tbHits)
 {
     using namespace fmt;
     using namespace std::chrono_literals;
@@ -47,12 +52,13 @@ inline void printSearchInfoPretty(std::shared_ptr<search::Searcher> searcher, Sc
     const auto timeDiff = TimeManager::timeElapsedMs();
     const auto knps = nodes / (timeDiff.count() + 1);
 
+    const Score score = pv.report.score;
     const auto scoreCp = score / 100.f;
     const auto mateScore = scoreMateDistance(score);
     const auto scoreColor = score < 0 ? fg(color::red) : fg(color::lawn_green);
 
     const auto hashFull = core::TranspositionTable::getHashFull() / 10.0;
-    const auto selDepth = searcher->getSelDepth();
+    const auto selDepth = pv.selDepth;
 
     std::string scoreBuffer;
     if (mateScore) {
@@ -107,7 +113,7 @@ inline void printSearchInfoPretty(std::shared_ptr<search::Searcher> searcher, Sc
 
     println(
         "{:>3}/{:<3} ║ {:>6} ║ {:>7} ║ {:>5.1f}% tt ║ {:>13} ║ {:>8} ║ {}PV: {}",
-        styled(currentDepth, fg(color::light_sky_blue)),
+        styled(pv.report.depth, fg(color::light_sky_blue)),
         styled(selDepth, fg(color::light_blue)),
         styled(scoreBuffer, scoreColor),
         styled(timeBuffer, fg(color::yellow)),
@@ -115,7 +121,7 @@ inline void printSearchInfoPretty(std::shared_ptr<search::Searcher> searcher, Sc
         styled(nodesBuffer, fg(color::light_gray)),
         styled(npsBuffer, fg(color::light_gray)),
         styled(tbHitsBuffer, fg(color::light_gray)),
-        styled(join(searcher->getPvTable(), " "), fg(color::dim_gray)));
+        styled(join(pv, " "), fg(color::dim_gray)));
 }
 
 void printHeader()
@@ -172,6 +178,21 @@ inline bool getPrettyPrintEnabled()
     return s_isPrettyPrintEnabled;
 }
 
+/* tools with machine readable output can disable the search info lines */
+inline void setSearchInfoEnabled(bool enabled)
+{
+    s_isSearchInfoEnabled = enabled;
+}
+
+/* instruction sets selected for this host - some are chosen at runtime */
+inline std::string getBuiltinFeatures()
+{
+    return fmt::format("{} sliders, {} popcount, {} nnue",
+        magic::s_usePext ? "PEXT" : "magic",
+        utils::popcountPath(),
+        nnue::simd::simdPathToString(nnue::simd::s_simdPath));
+}
+
 inline void printEngineInfo()
 {
     printHeader();
@@ -188,7 +209,7 @@ inline void printEngineInfo()
         printTitleInfoFnc("Version:", s_meltdownVersion);
         printTitleInfoFnc("Build Hash:", s_meltdownBuildHash);
         printTitleInfoFnc("Build Type:", s_meltdownBuildType);
-        printTitleInfoFnc("Builtin:", s_meltdownBuiltinFeature);
+        printTitleInfoFnc("Builtin:", getBuiltinFeatures());
         fmt::print("\n");
 
 #if defined(TUNING) || defined(SPSA)
@@ -205,7 +226,7 @@ inline void printEngineInfo()
                    "Build hash:  {}\n"
                    "Build type:  {}\n"
                    "Builtin:     {}\n\n",
-            s_meltdownVersion, s_meltdownBuildHash, s_meltdownBuildType, s_meltdownBuiltinFeature);
+            s_meltdownVersion, s_meltdownBuildHash, s_meltdownBuildType, getBuiltinFeatures());
 
 #if defined(TUNING) || defined(SPSA)
         fmt::println("!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n\n"
@@ -216,12 +237,16 @@ inline void printEngineInfo()
     }
 }
 
-inline void printSearchInfo(std::shared_ptr<search::Searcher> searcher, Score score, uint8_t currentDepth, uint64_t nodes, uint64_t tbHits)
+inline void printSearchInfo(const search::SearcherPv& pv, uint64_t nodes, uint64_t tbHits)
 {
+    if (!s_isSearchInfoEnabled) {
+        return;
+    }
+
     if (s_isPrettyPrintEnabled) {
-        printSearchInfoPretty(searcher, score, currentDepth, nodes, tbHits);
+        printSearchInfoPretty(pv, nodes, tbHits);
     } else {
-        printSearchInfoUci(searcher, score, currentDepth, nodes, tbHits);
+        printSearchInfoUci(pv, nodes, tbHits);
     }
 
     fflush(stdout);
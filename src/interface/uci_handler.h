@@ -9,6 +9,7 @@
 #include "tools/perft.h"
 
 #include "interface/uci_options.h"
+#include "nnue/nnue.h"
 #include "syzygy/syzygy.h"
 #include "version/version.h"
 
@@ -25,7 +26,7 @@ public:
     static void run()
     {
         s_board = parsing::FenParser::parse(s_startPosFen).value();
-        core::TranspositionTable::setSizeMb(s_defaultTtSizeMb);
+        s_evaluator.setHashSizeMb(s_defaultTtSizeMb);
         s_evaluator.reset();
 
         startInputThread();
@@ -177,7 +178,7 @@ private:
     {
         s_board = parsing::FenParser::parse(s_startPosFen).value();
         s_evaluator.reset();
-        core::TranspositionTable::clear();
+        s_evaluator.clearHashTable();
 
         return true;
     }
@@ -216,6 +217,8 @@ private:
                 TimeManager::setMovesToGo(valNum.value_or(0));
             } else if (setting == "movetime") {
                 TimeManager::setMoveTime(valNum.value_or(0));
+            } else if (setting == "nodes") {
+                TimeManager::setNodeLimit(valNum.value_or(0));
             } else if (setting == "winc") {
                 TimeManager::setWhiteMoveInc(valNum.value_or(0));
             } else if (setting == "binc") {
@@ -301,7 +304,9 @@ private:
 #endif
         } else if (command == "clear") {
             s_evaluator.reset();
-            core::TranspositionTable::clear();
+            s_evaluator.clearHashTable();
+        } else if (command == "hash") {
+            printHashInfo();
         } else if (command == "syzygy") {
             const auto wdl = syzygy::probeWdl(s_board);
             fmt::println("wdl: {}, table size: {}", wdl, syzygy::tableSize());
@@ -314,9 +319,43 @@ private:
 
     static bool handlePerft(std::string_view args)
     {
-        const auto depth = parsing::to_number(args);
-        if (depth.has_value()) {
-            tools::Perft::run(s_board, depth.value());
+        const auto [mode, modeArgs] = parsing::split_sv_by_space(args);
+        if (mode == "detailed") {
+            const auto depth = parsing::to_number(modeArgs);
+            if (depth.has_value()) {
+                tools::Perft::run(s_board, depth.value());
+            } else {
+                fmt::println("invalid input: {}", args);
+            }
+
+            return true;
+        } else if (mode == "suite") {
+            /* perft suite <file> [depth] [threads] */
+            const auto [path, depthAndThreads] = parsing::split_sv_by_space(modeArgs);
+            const auto [depthArg, threadsArg] = parsing::split_sv_by_space(depthAndThreads);
+
+            const auto depth = depthArg.empty() ? std::make_optional<int64_t>(tools::Perft::s_maxSuiteDepth) : parsing::to_number(depthArg);
+            const auto threads = threadsArg.empty() ? std::make_optional<int64_t>(std::max(std::thread::hardware_concurrency(), 1u)) : parsing::to_number(threadsArg);
+
+            if (!path.empty() && depth.has_value() && *depth >= 0 && threads.has_value() && *threads > 0) {
+                std::ignore = tools::Perft::runSuite(path, std::min<int64_t>(*depth, tools::Perft::s_maxSuiteDepth), *threads);
+            } else {
+                fmt::println("invalid input: {}", args);
+            }
+
+            return true;
+        }
+
+        /* perft <depth> [threads] [hash] */
+        const auto [depthArg, threadsAndHash] = parsing::split_sv_by_space(args);
+        const auto [threadsArg, hashArg] = parsing::split_sv_by_space(threadsAndHash);
+
+        const auto depth = parsing::to_number(depthArg);
+        const auto threads = threadsArg.empty() ? std::make_optional<int64_t>(std::max(std::thread::hardware_concurrency(), 1u)) : parsing::to_number(threadsArg);
+        const auto hashSizeMb = hashArg.empty() ? std::make_optional<int64_t>(tools::Perft::s_defaultHashSizeMb) : parsing::to_number(hashArg);
+
+        if (depth.has_value() && threads.has_value() && *threads > 0 && hashSizeMb.has_value() && *hashSizeMb > 0) {
+            tools::Perft::runParallel(s_board, depth.value(), threads.value(), hashSizeMb.value());
         } else {
             fmt::println("invalid input: {}", args);
         }
@@ -332,11 +371,41 @@ private:
 
     static bool handleBench(std::string_view args)
     {
-        const auto depth = parsing::to_number(args);
-        if (depth.has_value()) {
-            tools::Bench::run(s_evaluator, *depth);
+        const auto [mode, modeArgs] = parsing::split_sv_by_space(args);
+        if (mode == "nnue") {
+            const auto depth = parsing::to_number(modeArgs);
+            if (depth.has_value()) {
+                tools::Bench::compareNnue(s_evaluator, *depth);
+            } else {
+                tools::Bench::compareNnue(s_evaluator);
+            }
+
+            return true;
+        } else if (mode == "scaling") {
+            const auto options = tools::Bench::parseOptions(modeArgs);
+            if (options.has_value()) {
+                tools::Bench::runScaling(s_evaluator, *options);
+            } else {
+                fmt::println("invalid input: {}", args);
+            }
+
+            return true;
+        } else if (mode == "latency") {
+            const auto options = tools::Bench::parseOptions(modeArgs);
+            if (options.has_value()) {
+                tools::Bench::runLatency(s_evaluator, *options);
+            } else {
+                fmt::println("invalid input: {}", args);
+            }
+
+            return true;
+        }
+
+        const auto options = tools::Bench::parseOptions(args);
+        if (options.has_value()) {
+            tools::Bench::run(s_evaluator, *options);
         } else {
-            tools::Bench::run(s_evaluator);
+            fmt::println("invalid input: {}", args);
         }
 
         return true;
@@ -373,7 +442,7 @@ private:
                    "Build hash:  {}\n"
                    "Build type:  {}\n"
                    "Builtin:     {}\n\n",
-            s_meltdownVersion, s_meltdownBuildHash, s_meltdownBuildType, s_meltdownBuiltinFeature);
+            s_meltdownVersion, s_meltdownBuildHash, s_meltdownBuildType, interface::getBuiltinFeatures());
         return true;
     }
 
@@ -387,8 +456,24 @@ private:
                    "debug position      :  print the current position\n"
                    "debug clear         :  clear all scoring tables\n"
                    "debug options       :  print all options\n"
+                   "debug hash          :  print hash table size and page type\n"
                    "debug syzygy        :  run syzygy evaluation on current position\n"
-                   "bench <depth>       :  run a bench test - depth is optional\n"
+                   "perft <depth> <threads> <hash>\n"
+                   "                    :  fast perft - threads and hash (MB) are optional\n"
+                   "perft detailed <depth>\n"
+                   "                    :  slower perft that also counts captures, checks etc.\n"
+                   "perft suite <file.epd> <depth> <threads>\n"
+                   "                    :  verify all positions in a perft EPD file - depth limits the\n"
+                   "                       depths being checked, depth and threads are optional\n"
+                   "bench <options>     :  run a bench test - all options are optional:\n"
+                   "                       <depth> | depth <n> | nodes <n> | movetime <ms>\n"
+                   "                       threads <n> | hash <mb> | json | deterministic\n"
+                   "bench nnue <depth>  :  compare nnue against the hand crafted evaluation\n"
+                   "bench scaling <options>\n"
+                   "                    :  time to depth with 1, 2, 4.. threads - threads sets the max\n"
+                   "bench latency <options>\n"
+                   "                    :  time from stop/timeout to bestmove (p50, p99, max) with\n"
+                   "                       1, 2, 4.. threads - threads sets the max\n"
                    "pprint <on/off>     :  enable/disable pretty printing\n"
                    "spsa                :  print spsa inputs\n"
                    "authors             :  print author information\n"
@@ -407,6 +492,13 @@ private:
     constexpr static inline std::size_t s_inputBufferSize { 1024 * 6 };
 
     /* UCI options callbacks */
+    static inline void printHashInfo()
+    {
+        fmt::println("info string hash table {}MB using {} pages",
+            core::TranspositionTable::getSizeMb(),
+            utils::pageTypeToString(core::TranspositionTable::getPageType()));
+    }
+
     static inline void syzygyPathCallback(std::string_view path)
     {
         syzygy::deinit();
@@ -418,6 +510,22 @@ private:
         }
     }
 
+    /* none, cores or numa - see utils::ThreadBinding */
+    static inline void threadBindingCallback(std::string_view input)
+    {
+        const auto binding = utils::threadBindingFromString(input);
+        if (!binding.has_value()) {
+            fmt::println("info string invalid thread binding: {} - use none, cores or numa", input);
+            return;
+        }
+
+        s_evaluator.setThreadBinding(*binding);
+        fmt::println("info string threads bound to {} - {} cpus on {} numa nodes",
+            utils::threadBindingToString(*binding),
+            utils::CpuTopology::allowedCpus().size(),
+            utils::CpuTopology::numaNodes().size());
+    }
+
     /* declare UCI options */
     static inline auto s_uciOptions = std::to_array<ucioption::UciOption>({
         ucioption::make<ucioption::check>("Ponder", false, [](bool enabled) { s_evaluator.setPondering(enabled); }),
@@ -428,10 +536,30 @@ private:
              * mute warnings from OpenBench */
             std::ignore = val;
         }),
-        ucioption::make<ucioption::spin>("Hash", s_defaultTtSizeMb, ucioption::Limits { .min = 1, .max = 1024 }, [](int64_t val) { core::TranspositionTable::setSizeMb(val); }),
+        ucioption::make<ucioption::spin>("Hash", s_defaultTtSizeMb, ucioption::Limits { .min = 1, .max = s_maxTtSizeMb }, [](int64_t val) {
+            s_evaluator.setHashSizeMb(val);
+            printHashInfo();
+        }),
+        ucioption::make<ucioption::check>("LargePages", true, [](bool enabled) {
+            s_evaluator.setLargePages(enabled);
+            printHashInfo();
+        }),
         ucioption::make<ucioption::spin>("Threads", 1, ucioption::Limits { .min = 1, .max = s_maxThreads }, [](int64_t val) {
             s_evaluator.resizeSearchers(val);
         }),
+        ucioption::make<ucioption::string>("ThreadBinding", "none", ucioption::Combo { .vars = { "none", "cores", "numa" } }, threadBindingCallback),
+        ucioption::make<ucioption::check>("Deterministic", false, [](bool enabled) {
+            s_evaluator.setDeterministic(enabled);
+        }),
+        ucioption::make<ucioption::check>("UseNNUE", false, [](bool enabled) {
+            if (!nnue::Nnue::setEnabled(enabled)) {
+                fmt::println("info string NNUE is not available - using the hand crafted evaluation");
+            }
+
+            /* cached evaluations are from the previous backend */
+            s_evaluator.reset();
+            s_evaluator.clearHashTable();
+        }),
         ucioption::make<ucioption::spin>("MoveOverhead", s_defaultMoveOverhead.count(), ucioption::Limits { .min = 0, .max = 10000 }, [](int64_t val) {
             TimeManager::setMoveOverhead(val);
         }),
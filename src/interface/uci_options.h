@@ -3,12 +3,14 @@
 #include "parsing/input_parsing.h"
 
 #include "fmt/base.h"
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <variant>
+#include <vector>
 
 namespace ucioption {
 
@@ -34,10 +36,16 @@ struct Limits {
     int64_t max;
 };
 
+/* allowed values of a string option - makes it a uci combo */
+struct Combo {
+    std::vector<std::string_view> vars;
+};
+
 struct UciOption {
     const std::string_view name;
     Variant variant;
     const std::optional<Limits> limits {};
+    const std::optional<Combo> combo {};
 };
 
 template<typename T>
@@ -59,9 +67,20 @@ constexpr auto make(std::string_view name, T defaultVal, Limits limits, std::fun
     };
 }
 
+template<typename T>
+    requires std::is_same_v<T, string>
+constexpr auto make(std::string_view name, T defaultVal, Combo combo, std::function<void(const T&)> cb)
+{
+    return UciOption {
+        .name = name,
+        .variant = Storage<T> { .value = defaultVal, .defaultValue = defaultVal, .callback = std::move(cb) },
+        .combo = std::move(combo),
+    };
+}
+
 constexpr bool handleInput(UciOption& option, std::string_view input)
 {
-    return std::visit([input, limits = option.limits](auto&& arg) {
+    return std::visit([input, limits = option.limits, &combo = option.combo](auto&& arg) {
         using T = std::decay_t<decltype(arg)>;
         if constexpr (std::is_same_v<T, Storage<bool>>) {
             if (input == "true") {
@@ -72,6 +91,10 @@ constexpr bool handleInput(UciOption& option, std::string_view input)
                 return false;
             }
         } else if constexpr (std::is_same_v<T, Storage<std::string>>) {
+            if (combo.has_value() && std::ranges::find(combo->vars, input) == combo->vars.end()) {
+                return false;
+            }
+
             arg.value = input;
         } else if constexpr (std::is_same_v<T, Storage<int64_t>>) {
             const auto inputNum = parsing::to_number(input);
@@ -135,6 +158,16 @@ constexpr std::string_view uciTypeToString(Variant variant)
 /* custom printer to print uci information (needed for eg. "uci" from handler) */
 constexpr void printInfo(const UciOption& option)
 {
+    if (option.combo.has_value()) {
+        const auto& defaultValue = std::get<Storage<std::string>>(option.variant).defaultValue;
+        fmt::print("option name {} type combo default {}", option.name, defaultValue);
+        for (const auto var : option.combo->vars) {
+            fmt::print(" var {}", var);
+        }
+        fmt::println("");
+        return;
+    }
+
     std::visit([typeString = uciTypeToString(option.variant), name = option.name, limits = option.limits](auto&& arg) {
         if (limits.has_value()) {
             fmt::println("option name {} type {} default {} min {} max {}",
@@ -1,11 +1,21 @@
 #pragma once
 
+#include "utils/cpu_features.h"
+
 #include <array>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
 
 namespace magic {
 
-using SliderAttackTable = std::array<uint64_t, 4096>;
+/* builds targeting BMI2 always use PEXT - a runtime branch in the slider lookups is measurably slower
+ * portable builds use PEXT only when the host has a fast implementation - otherwise magic hashing */
+#ifdef __BMI2__
+static inline const bool s_usePext = true;
+#else
+static inline const bool s_usePext = utils::s_cpuFeatures.fastPext;
+#endif
 
 constexpr bool getBit(uint64_t bitboard, int square)
 {
@@ -19,27 +29,53 @@ constexpr void popBit(uint64_t& bitboard, int square)
     }
 }
 
-constexpr uint64_t set_occupancy(int index, int bitsInMask, uint64_t attackMask)
+/* amount of entries needed to store the attacks of all squares back to back
+ * each square needs an entry for every subset of its relevant occupancy mask */
+constexpr std::size_t packedTableSize(const std::array<uint64_t, 64>& masks)
 {
-    uint64_t occupancy = 0;
+    std::size_t size = 0;
+    for (const auto mask : masks) {
+        size += 1ULL << std::popcount(mask);
+    }
+
+    return size;
+}
+
+/* slider attacks for all squares packed into a single table
+ * a square's attacks start at its offset and the index is found by either PEXT or magic hashing
+ * the two methods order the entries differently - so each has its own table */
+template<std::size_t size>
+struct PackedSliderTable {
+    std::array<uint32_t, 64> offsets;
+    std::array<uint64_t, size> attacks;
+};
 
-    for (int count = 0; count < bitsInMask; ++count) {
-        if (attackMask == 0)
-            break; // Prevents undefined behavior
+/* generates the packed table - intended to be evaluated at compile time
+ * subsets of each mask are enumerated with the carry-rippler trick, which visits them in PEXT index order
+ * indexFunc(square, occupancy, subsetIndex) maps an occupancy to its index within the square
+ * attacksFunc(square, occupancy) computes the attacks for the occupancy */
+template<std::size_t size, typename IndexFunc, typename AttacksFunc>
+constexpr PackedSliderTable<size> generatePackedTable(const std::array<uint64_t, 64>& masks, IndexFunc&& indexFunc, AttacksFunc&& attacksFunc)
+{
+    PackedSliderTable<size> table {};
 
-        // Get LS1B index
-        int square = std::countr_zero(attackMask);
+    uint32_t offset = 0;
+    for (int square = 0; square < 64; square++) {
+        const uint64_t mask = masks[square];
+        table.offsets[square] = offset;
 
-        // Clear LS1B in attack mask
-        attackMask &= attackMask - 1;
+        uint64_t occupancy = 0;
+        uint32_t subsetIndex = 0;
+        do {
+            table.attacks[offset + indexFunc(square, occupancy, subsetIndex)] = attacksFunc(square, occupancy);
+            occupancy = (occupancy - mask) & mask;
+            subsetIndex++;
+        } while (occupancy);
 
-        // Populate occupancy map if bit in index is set
-        if (index & (1 << count)) {
-            occupancy |= (1ULL << square);
-        }
+        offset += subsetIndex;
     }
 
-    return occupancy;
+    return table;
 }
 
 } // end namespace magic
@@ -3,11 +3,31 @@
 
 int main(int argc, char** argv)
 {
+    /* fail gracefully instead of crashing on an illegal instruction */
+    if (const auto missingFeature = utils::findMissingCpuFeature()) {
+        fmt::println("This build of Meltdown requires {} which this CPU does not support\n"
+                     "Please use a build targeting an older architecture (eg. x86-64-v2)",
+            *missingFeature);
+        return 1;
+    }
+
+    /* bench options can follow, eg: meltdown bench threads 4 hash 256 json */
     const auto args = std::span(argv, argc);
-    for (const auto arg : args) {
-        if (std::strcmp(arg, "bench") == 0) {
+    for (auto itr = args.begin(); itr != args.end(); itr++) {
+        if (std::strcmp(*itr, "bench") == 0) {
+            std::string benchArgs;
+            for (auto argItr = std::next(itr); argItr != args.end(); argItr++) {
+                benchArgs += benchArgs.empty() ? *argItr : fmt::format(" {}", *argItr);
+            }
+
+            const auto options = tools::Bench::parseOptions(benchArgs);
+            if (!options.has_value()) {
+                fmt::println("invalid bench options: {}", benchArgs);
+                return 1;
+            }
+
             evaluation::Evaluator evaluator {};
-            tools::Bench::run(evaluator);
+            tools::Bench::run(evaluator, *options);
             return 0;
         }
     }
@@ -1,16 +1,12 @@
 #pragma once
 
 #include "core/board_defs.h"
+#include "magics/hashing.h"
 #include "magics/magics.h"
+#include "utils/bit_operations.h"
 #include <array>
 #include <cstdint>
 
-#ifdef __BMI2__
-#include <immintrin.h>
-#else
-#include "magics/hashing.h"
-#endif
-
 namespace movegen {
 
 namespace {
@@ -94,54 +90,49 @@ constexpr uint64_t bishopAttacksWithBlock(int square, uint64_t block)
     return attacks;
 }
 
-constexpr auto generateBishopAttackTable()
-{
-    std::array<magic::SliderAttackTable, 64> attacks;
+constexpr std::size_t s_bishopTableSize = magic::packedTableSize(s_bishopMasksTable);
 
-    for (int square = 0; square < 64; square++) {
-        const uint64_t attackMask = s_bishopMasksTable[square];
-        const int relevantBitsCount = std::popcount(attackMask);
-        const int occupancyIndicies = (1 << relevantBitsCount);
+/* subsets are visited in pext order */
+constexpr auto s_bishopPextTable = magic::generatePackedTable<s_bishopTableSize>(
+    s_bishopMasksTable,
+    []([[maybe_unused]] int square, [[maybe_unused]] uint64_t occupancy, uint32_t subsetIndex) -> uint32_t {
+        return subsetIndex;
+    },
+    bishopAttacksWithBlock);
 
-        for (int index = 0; index < occupancyIndicies; index++) {
-            const uint64_t occupancy = magic::set_occupancy(index, relevantBitsCount, attackMask);
+constexpr auto s_bishopMagicTable = magic::generatePackedTable<s_bishopTableSize>(
+    s_bishopMasksTable,
+    [](int square, uint64_t occupancy, [[maybe_unused]] uint32_t subsetIndex) -> uint32_t {
+        return (occupancy * magic::hashing::bishops::s_magic[square]) >> (64 - magic::hashing::bishops::s_relevantBits[square]);
+    },
+    bishopAttacksWithBlock);
 
-#ifdef __BMI2__
-            // pext_u64 is not available at compile time
-            int magicIndex = 0, bit = 1;
-            for (uint64_t m = attackMask; m; m &= (m - 1)) {
-                if (occupancy & (m & -m)) {
-                    magicIndex |= bit;
-                }
-                bit <<= 1;
-            }
-#else
-            const int magicIndex = (occupancy * magic::hashing::bishops::s_magic[square]) >> (64 - magic::hashing::bishops::s_relevantBits[square]);
-#endif
-            attacks[square][magicIndex] = bishopAttacksWithBlock(square, occupancy);
-        }
-    }
-
-    return attacks;
 }
 
-static inline auto s_bishopAttackTable = generateBishopAttackTable();
-
+/* https://www.chessprogramming.org/Magic_Bitboards */
+// https://www.chessprogramming.org/BMI2#PEXT_Bitboards
+static inline uint64_t getBishopMovesPext(BoardPosition pos, uint64_t occupancy)
+{
+    occupancy = utils::pext(occupancy, s_bishopMasksTable[pos]);
+    return s_bishopPextTable.attacks[s_bishopPextTable.offsets[pos] + occupancy];
 }
 
 /* https://www.chessprogramming.org/Magic_Bitboards */
-static inline uint64_t getBishopMoves(BoardPosition pos, uint64_t occupancy)
+static inline uint64_t getBishopMovesMagic(BoardPosition pos, uint64_t occupancy)
 {
-#ifdef __BMI2__
-    // https://www.chessprogramming.org/BMI2#PEXT_Bitboards
-    occupancy = _pext_u64(occupancy, s_bishopMasksTable[pos]);
-#else
-    /* https://www.chessprogramming.org/Magic_Bitboards */
     occupancy &= s_bishopMasksTable[pos];
     occupancy *= magic::hashing::bishops::s_magic[pos];
     occupancy >>= 64 - magic::hashing::bishops::s_relevantBits[pos];
+    return s_bishopMagicTable.attacks[s_bishopMagicTable.offsets[pos] + occupancy];
+}
+
+static inline uint64_t getBishopMoves(BoardPosition pos, uint64_t occupancy)
+{
+#ifdef __BMI2__
+    return getBishopMovesPext(pos, occupancy);
+#else
+    return magic::s_usePext ? getBishopMovesPext(pos, occupancy) : getBishopMovesMagic(pos, occupancy);
 #endif
-    return s_bishopAttackTable[pos][occupancy];
 }
 
 }
@@ -29,6 +29,11 @@ constexpr static inline void generateKnightMoves(ValidMoves& validMoves, uint64_
             utils::bitIterate(moves, [&](BoardPosition pos) {
                 validMoves.addMove(Move::create(from, pos, true));
             });
+        } else if constexpr (type == MoveQuiet) {
+            const uint64_t moves = getKnightMoves(from) & ~(ownOccupation | theirOccupation);
+            utils::bitIterate(moves, [&](BoardPosition pos) {
+                validMoves.addMove(Move::create(from, pos, false));
+            });
         } else {
             static_assert(false, "Missing move type implementation");
         }
@@ -50,6 +55,11 @@ constexpr static inline void generateRookMoves(ValidMoves& validMoves, uint64_t
             utils::bitIterate(moves, [&](BoardPosition pos) {
                 validMoves.addMove(Move::create(from, pos, true));
             });
+        } else if constexpr (type == MoveQuiet) {
+            const uint64_t moves = getRookMoves(from, ownOccupation | theirOccupation) & ~(ownOccupation | theirOccupation);
+            utils::bitIterate(moves, [&](BoardPosition pos) {
+                validMoves.addMove(Move::create(from, pos, false));
+            });
         } else {
             static_assert(false, "Missing move type implementation");
         }
@@ -71,6 +81,11 @@ constexpr static inline void generateBishopMoves(ValidMoves& validMoves, uint64_
             utils::bitIterate(moves, [&](BoardPosition pos) {
                 validMoves.addMove(Move::create(from, pos, true));
             });
+        } else if constexpr (type == MoveQuiet) {
+            const uint64_t moves = getBishopMoves(from, ownOccupation | theirOccupation) & ~(ownOccupation | theirOccupation);
+            utils::bitIterate(moves, [&](BoardPosition pos) {
+                validMoves.addMove(Move::create(from, pos, false));
+            });
         } else {
             static_assert(false, "Missing move type implementation");
         }
@@ -99,6 +114,11 @@ constexpr static inline void generateKingMoves(ValidMoves& validMoves, uint64_t
             utils::bitIterate(moves, [&](BoardPosition pos) {
                 validMoves.addMove(Move::create(from, pos, true));
             });
+        } else if constexpr (type == MoveQuiet) {
+            const uint64_t moves = s_kingsTable.at(from) & ~(ownOccupation | theirOccupation) & ~attacks;
+            utils::bitIterate(moves, [&](BoardPosition pos) {
+                validMoves.addMove(Move::create(from, pos, false));
+            });
         } else {
             static_assert(false, "Missing move type implementation");
         }
@@ -214,12 +234,12 @@ constexpr static inline void getPawnMoves(ValidMoves& validMoves, const BitBoard
 {
     if constexpr (player == PlayerWhite) {
         getWhitePawnMoves<type>(validMoves, board.pieces[WhitePawn], board.occupation[White], board.occupation[Black]);
-        if (board.enPessant.has_value()) {
+        if (type != MoveQuiet && board.enPessant.has_value()) {
             getWhiteEnPessantMoves(validMoves, board.pieces[WhitePawn], board.enPessant.value(), board.occupation[Both]);
         }
     } else {
         getBlackPawnMoves<type>(validMoves, board.pieces[BlackPawn], board.occupation[Black], board.occupation[White]);
-        if (board.enPessant.has_value()) {
+        if (type != MoveQuiet && board.enPessant.has_value()) {
             getBlackEnPessantMoves(validMoves, board.pieces[BlackPawn], board.enPessant.value(), board.occupation[Both]);
         }
     }
@@ -10,7 +10,8 @@ namespace movegen {
 enum MoveType {
     MovePseudoLegal,
     MoveCapture,
-    MoveNoisy,
+    MoveNoisy, /* captures and promotions */
+    MoveQuiet, /* everything but MoveNoisy */
 };
 
 /* NOTE: all captures have 0b100 set
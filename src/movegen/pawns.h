@@ -56,13 +56,18 @@ constexpr static inline void getWhitePawnMoves(ValidMoves& validMoves, uint64_t
      * attackRight -> same as left but the other direction
      */
 
-    if constexpr (type == MovePseudoLegal) {
+    if constexpr (type == MovePseudoLegal || type == MoveQuiet) {
         uint64_t moveStraight = ((pawns & ~s_row7Mask) << 8) & ~allOccupation;
         uint64_t moveStraightDouble = ((pawns & s_row2Mask) << 16) & ~(allOccupation | (allOccupation << 8));
         backtrackPawnMoves(validMoves, moveStraight, 8, false);
         backtrackPawnEnPessantMoves(validMoves, moveStraightDouble, 16, true);
     }
 
+    /* the remaining moves are all noisy */
+    if constexpr (type == MoveQuiet) {
+        return;
+    }
+
     uint64_t attackLeft = ((pawns & ~s_row7Mask & ~s_aFileMask) << 7) & theirOccupation;
     uint64_t attackRight = ((pawns & ~s_row7Mask & ~s_hFileMask) << 9) & theirOccupation;
 
@@ -86,7 +91,7 @@ constexpr static inline void getBlackPawnMoves(ValidMoves& validMoves, uint64_t
 {
     const uint64_t allOccupation = theirOccupation | ownOccupation;
 
-    if constexpr (type == MovePseudoLegal) {
+    if constexpr (type == MovePseudoLegal || type == MoveQuiet) {
         uint64_t moveStraight = ((pawns & ~s_row2Mask) >> 8) & ~allOccupation;
         uint64_t moveStraightDouble = ((pawns & s_row7Mask) >> 16) & ~(allOccupation | (allOccupation >> 8));
 
@@ -94,6 +99,11 @@ constexpr static inline void getBlackPawnMoves(ValidMoves& validMoves, uint64_t
         backtrackPawnEnPessantMoves(validMoves, moveStraightDouble, -16, true);
     }
 
+    /* the remaining moves are all noisy */
+    if constexpr (type == MoveQuiet) {
+        return;
+    }
+
     uint64_t attackLeft = ((pawns & ~s_row2Mask & ~s_aFileMask) >> 9) & theirOccupation;
     uint64_t attackRight = ((pawns & ~s_row2Mask & ~s_hFileMask) >> 7) & theirOccupation;
 
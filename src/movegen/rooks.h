@@ -1,17 +1,13 @@
 #pragma once
 
 #include "core/board_defs.h"
+#include "magics/hashing.h"
 #include "magics/magics.h"
+#include "utils/bit_operations.h"
 
 #include <array>
 #include <cstdint>
 
-#ifdef __BMI2__
-#include <immintrin.h>
-#else
-#include "magics/hashing.h"
-#endif
-
 namespace movegen {
 
 namespace {
@@ -86,54 +82,48 @@ constexpr uint64_t rookAttacksWithBlock(int square, uint64_t block)
     return attacks;
 }
 
-constexpr auto generateRookAttackTable()
-{
-    std::array<magic::SliderAttackTable, 64> attacks;
+constexpr std::size_t s_rookTableSize = magic::packedTableSize(s_rookMasksTable);
 
-    for (int square = 0; square < 64; square++) {
+/* subsets are visited in pext order */
+constexpr auto s_rookPextTable = magic::generatePackedTable<s_rookTableSize>(
+    s_rookMasksTable,
+    []([[maybe_unused]] int square, [[maybe_unused]] uint64_t occupancy, uint32_t subsetIndex) -> uint32_t {
+        return subsetIndex;
+    },
+    rookAttacksWithBlock);
 
-        const uint64_t attackMask = s_rookMasksTable[square];
-        const int relevantBitsCount = std::popcount(attackMask);
-        const int occupancyIndicies = (1 << relevantBitsCount);
+constexpr auto s_rookMagicTable = magic::generatePackedTable<s_rookTableSize>(
+    s_rookMasksTable,
+    [](int square, uint64_t occupancy, [[maybe_unused]] uint32_t subsetIndex) -> uint32_t {
+        return (occupancy * magic::hashing::rooks::s_magic[square]) >> (64 - magic::hashing::rooks::s_relevantBits[square]);
+    },
+    rookAttacksWithBlock);
 
-        for (int index = 0; index < occupancyIndicies; index++) {
-            const uint64_t occupancy = magic::set_occupancy(index, relevantBitsCount, attackMask);
-
-#ifdef __BMI2__
-            // pext_u64 is not available at compile time
-            int magicIndex = 0, bit = 1;
-            for (uint64_t m = attackMask; m; m &= (m - 1)) {
-                if (occupancy & (m & -m)) {
-                    magicIndex |= bit;
-                }
-                bit <<= 1;
-            }
-#else
-            const int magicIndex = (occupancy * magic::hashing::rooks::s_magic[square]) >> (64 - magic::hashing::rooks::s_relevantBits[square]);
-#endif
-            attacks[square][magicIndex] = rookAttacksWithBlock(square, occupancy);
-        }
-    }
+} // end namespace
 
-    return attacks;
+// https://www.chessprogramming.org/BMI2#PEXT_Bitboards
+static inline uint64_t getRookMovesPext(BoardPosition pos, uint64_t occupancy)
+{
+    occupancy = utils::pext(occupancy, s_rookMasksTable[pos]);
+    return s_rookPextTable.attacks[s_rookPextTable.offsets[pos] + occupancy];
 }
 
-static inline auto s_rookAttackTable = generateRookAttackTable();
-
-} // end namespace
+/* https://www.chessprogramming.org/Magic_Bitboards */
+static inline uint64_t getRookMovesMagic(BoardPosition pos, uint64_t occupancy)
+{
+    occupancy &= s_rookMasksTable[pos];
+    occupancy *= magic::hashing::rooks::s_magic[pos];
+    occupancy >>= 64 - magic::hashing::rooks::s_relevantBits[pos];
+    return s_rookMagicTable.attacks[s_rookMagicTable.offsets[pos] + occupancy];
+}
 
 static inline uint64_t getRookMoves(BoardPosition pos, uint64_t occupancy)
 {
 #ifdef __BMI2__
-    // https://www.chessprogramming.org/BMI2#PEXT_Bitboards
-    occupancy = _pext_u64(occupancy, s_rookMasksTable[pos]);
+    return getRookMovesPext(pos, occupancy);
 #else
-    /* https://www.chessprogramming.org/Magic_Bitboards */
-    occupancy &= s_rookMasksTable[pos];
-    occupancy *= magic::hashing::rooks::s_magic[pos];
-    occupancy >>= 64 - magic::hashing::rooks::s_relevantBits[pos];
+    return magic::s_usePext ? getRookMovesPext(pos, occupancy) : getRookMovesMagic(pos, occupancy);
 #endif
-    return s_rookAttackTable[pos][occupancy];
 }
 
 } // end namespace movegen
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "core/bit_board.h"
+#include "nnue/network.h"
+#include "nnue/simd.h"
+#include "utils/bit_operations.h"
+
+#include <array>
+#include <cassert>
+
+namespace nnue {
+
+/* hidden layer values for both perspectives
+ * the search keeps one per ply - making a move updates the child from the parent
+ * and undoing a move is simply stepping back to the parent */
+struct Accumulator {
+    alignas(64) std::array<std::array<int16_t, s_hiddenSize>, magic_enum::enum_count<Player>()> values;
+
+    /* computes the accumulator from scratch - only needed when setting up the root */
+    void refresh(const Network& network, const BitBoard& board)
+    {
+        values[PlayerWhite] = network.featureBias;
+        values[PlayerBlack] = network.featureBias;
+
+        for (uint8_t piece = 0; piece < s_amountPieces; piece++) {
+            utils::bitIterate(board.pieces[piece], [&](BoardPosition pos) {
+                addFeature<PlayerWhite>(network, static_cast<Piece>(piece), pos);
+                addFeature<PlayerBlack>(network, static_cast<Piece>(piece), pos);
+            });
+        }
+    }
+
+    /* updates the accumulator from the parent accumulator
+     * the changed features are found by comparing the boards before and after the move
+     * which covers captures, promotions, castling and en passant without decoding the move */
+    void update(const Network& network, const Accumulator& parent, const BitBoard& parentBoard, const BitBoard& board)
+    {
+        std::array<Feature, s_maxChanges> added;
+        std::array<Feature, s_maxChanges> removed;
+        std::size_t numAdded = 0;
+        std::size_t numRemoved = 0;
+
+        for (uint8_t piece = 0; piece < s_amountPieces; piece++) {
+            const uint64_t before = parentBoard.pieces[piece];
+            const uint64_t after = board.pieces[piece];
+
+            if (before == after) {
+                continue;
+            }
+
+            utils::bitIterate(after & ~before, [&](BoardPosition pos) {
+                assert(numAdded < s_maxChanges);
+                added[numAdded++] = Feature { static_cast<Piece>(piece), pos };
+            });
+
+            utils::bitIterate(before & ~after, [&](BoardPosition pos) {
+                assert(numRemoved < s_maxChanges);
+                removed[numRemoved++] = Feature { static_cast<Piece>(piece), pos };
+            });
+        }
+
+        applyChanges<PlayerWhite>(network, parent, std::span(added.data(), numAdded), std::span(removed.data(), numRemoved));
+        applyChanges<PlayerBlack>(network, parent, std::span(added.data(), numAdded), std::span(removed.data(), numRemoved));
+    }
+
+private:
+    /* castling moves two pieces - en passant and capturing promotions remove two */
+    constexpr static inline std::size_t s_maxChanges { 2 };
+
+    struct Feature {
+        Piece piece;
+        BoardPosition pos;
+    };
+
+    template<Player perspective>
+    void addFeature(const Network& network, Piece piece, BoardPosition pos)
+    {
+        const std::array<const int16_t*, 1> adds { network.featureWeights[featureIndex<perspective>(piece, pos)].data() };
+        simd::addSub<s_hiddenSize>(values[perspective].data(), values[perspective].data(), adds, {});
+    }
+
+    template<Player perspective>
+    void applyChanges(const Network& network, const Accumulator& parent, std::span<const Feature> added, std::span<const Feature> removed)
+    {
+        std::array<const int16_t*, s_maxChanges> adds;
+        std::array<const int16_t*, s_maxChanges> subs;
+
+        for (std::size_t i = 0; i < added.size(); i++) {
+            adds[i] = network.featureWeights[featureIndex<perspective>(added[i].piece, added[i].pos)].data();
+        }
+
+        for (std::size_t i = 0; i < removed.size(); i++) {
+            subs[i] = network.featureWeights[featureIndex<perspective>(removed[i].piece, removed[i].pos)].data();
+        }
+
+        simd::addSub<s_hiddenSize>(values[perspective].data(), parent.values[perspective].data(),
+            std::span(adds.data(), added.size()), std::span(subs.data(), removed.size()));
+    }
+};
+
+}
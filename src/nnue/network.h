@@ -0,0 +1,75 @@
+#pragma once
+
+#include "core/board_defs.h"
+#include "utils/bit_operations.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/* the network can be embedded in the binary by configuring meson with: -Dnnue-net=<path>
+ * GCC and clang don't support #embed yet so the file is included by the assembler
+ * NOTE: the symbols are defined in this header - fine as long as every executable is a single translation unit */
+#ifdef NNUE_NET_PATH
+#ifdef _WIN32
+#define NNUE_NET_SECTION ".section .rdata,\"dr\"\n"
+#else
+#define NNUE_NET_SECTION ".section .rodata\n"
+#endif
+
+asm(NNUE_NET_SECTION
+    ".balign 64\n"
+    ".global meltdownNnueData\n"
+    "meltdownNnueData:\n"
+    ".incbin \"" NNUE_NET_PATH "\"\n"
+    ".global meltdownNnueEnd\n"
+    "meltdownNnueEnd:\n"
+    ".byte 0\n"
+    ".previous\n");
+
+extern "C" const unsigned char meltdownNnueData[];
+extern "C" const unsigned char meltdownNnueEnd[];
+#endif
+
+namespace nnue {
+
+/* (768 -> 256)x2 -> 1 perspective network with SCReLU activation
+ * the layout matches the raw quantised output of bullet's simple example so nets can be used as is
+ *
+ * input features:  [relative color][piece type][square] - squares are flipped for black's perspective
+ * hidden layer:    one accumulator per perspective, updated incrementally when moves are made
+ * output:          side to move accumulator followed by the opponent accumulator */
+constexpr static inline std::size_t s_inputSize { 768 };
+constexpr static inline std::size_t s_hiddenSize { 256 };
+
+/* quantisation */
+constexpr static inline int32_t s_qa { 255 };
+constexpr static inline int32_t s_qb { 64 };
+constexpr static inline int32_t s_evalScale { 400 };
+
+struct Network {
+    alignas(64) std::array<std::array<int16_t, s_hiddenSize>, s_inputSize> featureWeights;
+    alignas(64) std::array<int16_t, s_hiddenSize> featureBias;
+    alignas(64) std::array<int16_t, s_hiddenSize * 2> outputWeights;
+    int16_t outputBias;
+};
+
+/* amount of bytes in a network file - trainers might pad the file */
+constexpr static inline std::size_t s_networkBytes { offsetof(Network, outputBias) + sizeof(Network::outputBias) };
+
+static_assert(offsetof(Network, featureBias) == sizeof(Network::featureWeights), "network must not be padded");
+static_assert(offsetof(Network, outputBias) == s_networkBytes - sizeof(int16_t), "network must not be padded");
+
+template<Player perspective>
+constexpr inline std::size_t featureIndex(Piece piece, BoardPosition pos)
+{
+    if constexpr (perspective == PlayerWhite) {
+        return piece * s_amountSquares + pos;
+    } else {
+        /* swap colors and mirror the board - black sees itself as white */
+        const uint8_t relativePiece = piece >= BlackPawn ? piece - BlackPawn : piece + BlackPawn;
+        return relativePiece * s_amountSquares + utils::flipPosition(pos);
+    }
+}
+
+}
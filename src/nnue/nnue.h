@@ -0,0 +1,98 @@
+#pragma once
+
+#include "evaluation/score.h"
+#include "nnue/accumulator.h"
+#include "nnue/network.h"
+#include "nnue/simd.h"
+
+#include "fmt/base.h"
+#include <algorithm>
+#include <cstring>
+
+namespace nnue {
+
+/* optional evaluation backend - the hand crafted evaluation is used unless enabled
+ * NOTE: enabling/disabling is NOT THREAD SAFE - only do it while not searching */
+class Nnue {
+public:
+    Nnue() = delete;
+
+    /* returns false if enabling was requested but no network is available
+     * a network is embedded by building with -Dnnue-net=<path> */
+    static bool setEnabled(bool enabled)
+    {
+        if (enabled && !s_loaded) {
+            s_loaded = loadEmbedded();
+        }
+
+        s_enabled = enabled && s_loaded;
+        return s_enabled == enabled;
+    }
+
+    static inline bool isEnabled()
+    {
+        return s_enabled;
+    }
+
+    static constexpr bool hasEmbeddedNetwork()
+    {
+#ifdef NNUE_NET_PATH
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /* copies the network from raw (little endian) network data */
+    static bool load(const unsigned char* data, std::size_t size)
+    {
+        if (size < s_networkBytes) {
+            fmt::println("info string invalid network size: {} bytes, expected {}", size, s_networkBytes);
+            return false;
+        }
+
+        std::memcpy(&s_network, data, s_networkBytes);
+        s_loaded = true;
+
+        return true;
+    }
+
+    static inline const Network& getNetwork()
+    {
+        return s_network;
+    }
+
+    /* evaluation of the position seen from the player to move */
+    static inline Score evaluate(const Accumulator& accumulator, Player player)
+    {
+        const auto& us = accumulator.values[player];
+        const auto& them = accumulator.values[nextPlayer(player)];
+
+        int32_t output = simd::screluDot<s_hiddenSize>(us.data(), s_network.outputWeights.data(), s_qa)
+            + simd::screluDot<s_hiddenSize>(them.data(), s_network.outputWeights.data() + s_hiddenSize, s_qa);
+
+        /* screlu squares the activation - remove one of the QA factors before adding the bias */
+        output /= s_qa;
+        output += s_network.outputBias;
+        output = output * s_evalScale / (s_qa * s_qb);
+
+        /* never let the network claim a mate */
+        return std::clamp<int32_t>(output, -s_mateScore + 1, s_mateScore - 1);
+    }
+
+private:
+    static bool loadEmbedded()
+    {
+#ifdef NNUE_NET_PATH
+        return load(meltdownNnueData, static_cast<std::size_t>(meltdownNnueEnd - meltdownNnueData));
+#else
+        return false;
+#endif
+    }
+
+    static inline Network s_network {};
+    static inline bool s_loaded { false };
+    static inline bool s_enabled { false };
+};
+
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "utils/cpu_features.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* int16 kernels used by the network
+ * every instruction set is compiled in (through target attributes) and the best one
+ * supported by the host is selected at startup
+ * all buffers must be 64 byte aligned and the size a multiple of 32 */
+
+namespace nnue::simd {
+
+enum class SimdPath {
+    Scalar,
+    Avx2,
+    Avx512,
+};
+
+inline SimdPath selectSimdPath()
+{
+    if (utils::s_cpuFeatures.avx512) {
+        return SimdPath::Avx512;
+    } else if (utils::s_cpuFeatures.avx2) {
+        return SimdPath::Avx2;
+    }
+
+    return SimdPath::Scalar;
+}
+
+static inline SimdPath s_simdPath = selectSimdPath();
+
+constexpr std::string_view simdPathToString(SimdPath path)
+{
+    switch (path) {
+    case SimdPath::Scalar:
+        return "scalar";
+    case SimdPath::Avx2:
+        return "AVX2";
+    case SimdPath::Avx512:
+        return "AVX512";
+    }
+
+    return "unknown";
+}
+
+namespace scalar {
+
+template<std::size_t size>
+inline void addSub(int16_t* output, const int16_t* input, std::span<const int16_t* const> adds, std::span<const int16_t* const> subs)
+{
+    for (std::size_t i = 0; i < size; i++) {
+        int16_t value = input[i];
+
+        for (const auto* add : adds) {
+            value += add[i];
+        }
+
+        for (const auto* sub : subs) {
+            value -= sub[i];
+        }
+
+        output[i] = value;
+    }
+}
+
+template<std::size_t size>
+inline int32_t screluDot(const int16_t* input, const int16_t* weights, int16_t clipMax)
+{
+    int32_t sum = 0;
+
+    for (std::size_t i = 0; i < size; i++) {
+        const int32_t clipped = std::clamp<int16_t>(input[i], 0, clipMax);
+        sum += static_cast<int16_t>(clipped * weights[i]) * clipped;
+    }
+
+    return sum;
+}
+
+}
+
+#if defined(__x86_64__)
+
+namespace avx2 {
+
+template<std::size_t size>
+__attribute__((target("avx2"))) void addSub(int16_t* output, const int16_t* input, std::span<const int16_t* const> adds, std::span<const int16_t* const> subs)
+{
+    static_assert(size % 16 == 0);
+
+    for (std::size_t i = 0; i < size; i += 16) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i));
+
+        for (const auto* add : adds) {
+            v = _mm256_add_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(add + i)));
+        }
+
+        for (const auto* sub : subs) {
+            v = _mm256_sub_epi16(v, _mm256_load_si256(reinterpret_cast<const __m256i*>(sub + i)));
+        }
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(output + i), v);
+    }
+}
+
+template<std::size_t size>
+__attribute__((target("avx2"))) int32_t screluDot(const int16_t* input, const int16_t* weights, int16_t clipMax)
+{
+    static_assert(size % 16 == 0);
+
+    const __m256i lower = _mm256_setzero_si256();
+    const __m256i upper = _mm256_set1_epi16(clipMax);
+    __m256i sum = _mm256_setzero_si256();
+
+    for (std::size_t i = 0; i < size; i += 16) {
+        const __m256i values = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i));
+        const __m256i clipped = _mm256_min_epi16(_mm256_max_epi16(values, lower), upper);
+        const __m256i product = _mm256_mullo_epi16(clipped, _mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(product, clipped));
+    }
+
+    __m128i reduced = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    reduced = _mm_add_epi32(reduced, _mm_shuffle_epi32(reduced, 0b01001110));
+    reduced = _mm_add_epi32(reduced, _mm_shuffle_epi32(reduced, 0b10110001));
+    return _mm_cvtsi128_si32(reduced);
+}
+
+}
+
+namespace avx512 {
+
+template<std::size_t size>
+__attribute__((target("avx512f,avx512bw"))) void addSub(int16_t* output, const int16_t* input, std::span<const int16_t* const> adds, std::span<const int16_t* const> subs)
+{
+    static_assert(size % 32 == 0);
+
+    for (std::size_t i = 0; i < size; i += 32) {
+        __m512i v = _mm512_load_si512(input + i);
+
+        for (const auto* add : adds) {
+            v = _mm512_add_epi16(v, _mm512_load_si512(add + i));
+        }
+
+        for (const auto* sub : subs) {
+            v = _mm512_sub_epi16(v, _mm512_load_si512(sub + i));
+        }
+
+        _mm512_store_si512(output + i, v);
+    }
+}
+
+template<std::size_t size>
+__attribute__((target("avx512f,avx512bw"))) int32_t screluDot(const int16_t* input, const int16_t* weights, int16_t clipMax)
+{
+    static_assert(size % 32 == 0);
+
+    const __m512i lower = _mm512_setzero_si512();
+    const __m512i upper = _mm512_set1_epi16(clipMax);
+    __m512i sum = _mm512_setzero_si512();
+
+    for (std::size_t i = 0; i < size; i += 32) {
+        const __m512i clipped = _mm512_min_epi16(_mm512_max_epi16(_mm512_load_si512(input + i), lower), upper);
+        const __m512i product = _mm512_mullo_epi16(clipped, _mm512_load_si512(weights + i));
+        sum = _mm512_add_epi32(sum, _mm512_madd_epi16(product, clipped));
+    }
+
+    return _mm512_reduce_add_epi32(sum);
+}
+
+}
+
+#endif
+
+/* output = input + sum(adds) - sum(subs)
+ * every row is applied in the same pass so the accumulator is only loaded and stored once */
+template<std::size_t size>
+inline void addSub(int16_t* output, const int16_t* input, std::span<const int16_t* const> adds, std::span<const int16_t* const> subs)
+{
+    switch (s_simdPath) {
+#if defined(__x86_64__)
+    case SimdPath::Avx512:
+        return avx512::addSub<size>(output, input, adds, subs);
+    case SimdPath::Avx2:
+        return avx2::addSub<size>(output, input, adds, subs);
+#endif
+    default:
+        return scalar::addSub<size>(output, input, adds, subs);
+    }
+}
+
+/* sum(screlu(input) * weights) where screlu(x) = clamp(x, 0, clipMax)^2
+ * computed as (c * w) * c so the inner product fits in int16 lanes
+ * NOTE: requires |c * w| to fit in int16 - networks are trained with weights clipped accordingly */
+template<std::size_t size>
+inline int32_t screluDot(const int16_t* input, const int16_t* weights, int16_t clipMax)
+{
+    switch (s_simdPath) {
+#if defined(__x86_64__)
+    case SimdPath::Avx512:
+        return avx512::screluDot<size>(input, weights, clipMax);
+    case SimdPath::Avx2:
+        return avx2::screluDot<size>(input, weights, clipMax);
+#endif
+    default:
+        return scalar::screluDot<size>(input, weights, clipMax);
+    }
+}
+
+}
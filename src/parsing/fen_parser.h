@@ -1,5 +1,6 @@
 #pragma once
 
+#include "evaluation/psqt.h"
 #include "parsing/input_parsing.h"
 #include "parsing/piece_parsing.h"
 
@@ -74,6 +75,7 @@ public:
         /* last thing to do - update hashes so they reflect the full board state */
         board.hash = core::generateHash(board);
         board.kpHash = core::generateKingPawnHash(board);
+        board.checkers = core::computeCheckers(board);
 
         if (success)
             return board;
@@ -101,6 +103,7 @@ public:
                 if (piece.has_value()) {
                     const auto pos = intToBoardPosition((row * 8) + column);
                     board.pieces[piece.value()] |= utils::positionToSquare(pos);
+                    board.pieceOn[pos] = piece.value();
                     column++;
                 } else {
                     const uint8_t skip = c - '0';
@@ -116,8 +119,8 @@ public:
 
         board.updateOccupation();
 
-        board.attacks[PlayerWhite] = attackgen::getAllAttacks<PlayerWhite>(board);
-        board.attacks[PlayerBlack] = attackgen::getAllAttacks<PlayerBlack>(board);
+        board.psqtScore = evaluation::computePsqtScore(board);
+        board.phase = evaluation::computePhase(board);
 
         return true;
     }
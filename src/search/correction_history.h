@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/attack_generation.h"
 #include "core/bit_board.h"
 #include "core/zobrist_hashing.h"
 #include "evaluation/score.h"
@@ -34,7 +35,7 @@ public:
     inline Score getCorrection(const BitBoard& board) const
     {
         constexpr Player opponent = nextPlayer(player);
-        const uint64_t threatKey = core::splitMixHash(board.attacks[opponent] & board.occupation[player]);
+        const uint64_t threatKey = core::splitMixHash(attackgen::getAllAttacks<opponent>(board) & board.occupation[player]);
 
         const Score kpCorrection = getEntry<player>(board.kpHash);
         const Score materialCorrection = getEntry<player>(core::generateMaterialHash(board));
@@ -52,7 +53,7 @@ public:
     inline void update(const BitBoard& board, uint8_t depth, Score score, Score eval)
     {
         constexpr Player opponent = nextPlayer(player);
-        const uint64_t threatKey = core::splitMixHash(board.attacks[opponent] & board.occupation[player]);
+        const uint64_t threatKey = core::splitMixHash(attackgen::getAllAttacks<opponent>(board) & board.occupation[player]);
 
         updateEntry<player>(board.kpHash, score, eval, depth);
         updateEntry<player>(core::generateMaterialHash(board), score, eval, depth);
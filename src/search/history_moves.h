@@ -21,7 +21,7 @@ public:
             return; // nothing to do
         }
 
-        const auto attacker = board.getAttackerAtSquare(move.fromSquare(), board.player);
+        const auto attacker = board.getAttackerAt(move.fromPos(), board.player);
 
         if (!attacker.has_value())
             return; // nothing to do
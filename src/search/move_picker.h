@@ -9,6 +9,8 @@
 #include "search/search_tables.h"
 #include "syzygy/syzygy.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 
 namespace search {
@@ -19,20 +21,22 @@ enum KillerMoveType {
 };
 
 enum MovePickerOffsets : int32_t {
-    KillerMoveFirst = 100003,
-    KillerMoveSecond = 100002,
-    CounterMove = 100001,
     BadPromotions = -10000,
 };
 
+/* moves are generated in stages - the tt move, killers and counter move are validated
+ * and tried before the moves they would otherwise be generated with. Quiets are only
+ * generated once all good noisy moves have been tried */
 enum PickerPhase {
     GenerateSyzygyMoves,
     Syzygy,
-    GenerateMoves,
     TtMove,
-    GenerateNoisyScores,
+    GenerateNoisyMoves,
     NoisyGood,
-    GenerateQuietScores,
+    KillerFirst,
+    KillerSecond,
+    Counter,
+    GenerateQuietMoves,
     QuietMove,
     NoisyBad,
     Done,
@@ -73,7 +77,33 @@ public:
         return m_skipQuiets;
     }
 
+    /* only legal moves are returned - the pin and check masks are computed on first use */
     template<Player player> constexpr std::optional<movegen::Move> pickNextMove(const BitBoard& board)
+    {
+        if (!m_legalityInfo.has_value())
+            m_legalityInfo = core::getLegalityInfo<player>(board);
+
+        while (const auto move = pickNextPseudoLegalMove<player>(board)) {
+            /* tablebase moves are legal already */
+            if (m_phase == PickerPhase::Syzygy || core::isLegal<player>(board, *move, *m_legalityInfo))
+                return move;
+        }
+
+        return std::nullopt;
+    }
+
+    // Helper: calling inside loops will mean redundant colour checks
+    constexpr std::optional<movegen::Move> pickNextMove(const BitBoard& board)
+    {
+        if (board.player == PlayerWhite) {
+            return pickNextMove<PlayerWhite>(board);
+        } else {
+            return pickNextMove<PlayerBlack>(board);
+        }
+    }
+
+private:
+    template<Player player> constexpr std::optional<movegen::Move> pickNextPseudoLegalMove(const BitBoard& board)
     {
         switch (m_phase) {
         case GenerateSyzygyMoves: {
@@ -82,10 +112,10 @@ public:
             if (syzygyActive) {
                 m_phase = PickerPhase::Syzygy;
             } else {
-                m_phase = PickerPhase::GenerateMoves;
+                m_phase = PickerPhase::TtMove;
             }
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
         case Syzygy: {
@@ -95,33 +125,26 @@ public:
 
             m_phase = PickerPhase::Done;
 
-            return pickNextMove<player>(board);
-        }
-
-        case GenerateMoves: {
-            core::getAllMoves<moveType>(board, m_moves);
-            m_tail = m_moves.count();
-
-            m_phase = PickerPhase::TtMove;
-
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
         case TtMove: {
-            if (const auto pickedMove = pickTtMove())
-                return pickedMove;
+            m_phase = PickerPhase::GenerateNoisyMoves;
 
-            m_phase = PickerPhase::GenerateNoisyScores;
+            /* the tt move is tried before generating any moves - a cutoff from it
+             * saves the entire move generation */
+            if (m_ttMove && core::isPseudoLegal<player, moveType>(board, *m_ttMove))
+                return pickRefutation(*m_ttMove);
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
-        case GenerateNoisyScores: {
-            generateNoisyScores(board);
+        case GenerateNoisyMoves: {
+            generateNoisyMoves(board);
 
             m_phase = PickerPhase::NoisyGood;
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
         case NoisyGood: {
@@ -132,23 +155,55 @@ public:
             if constexpr (moveType == movegen::MoveNoisy || moveType == movegen::MoveCapture) {
                 m_phase = PickerPhase::Done;
             } else {
-                m_phase = PickerPhase::GenerateQuietScores;
+                m_phase = PickerPhase::KillerFirst;
             }
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
+        }
+
+        case KillerFirst: {
+            m_phase = PickerPhase::KillerSecond;
+            m_killerMoves = m_searchTables.getKillerMove(m_ply);
+
+            if (!m_skipQuiets && isQuietRefutation<player>(board, m_killerMoves.first))
+                return pickRefutation(m_killerMoves.first);
+
+            return pickNextPseudoLegalMove<player>(board);
         }
 
-        case GenerateQuietScores: {
+        case KillerSecond: {
+            m_phase = PickerPhase::Counter;
+
+            if (!m_skipQuiets && isQuietRefutation<player>(board, m_killerMoves.second))
+                return pickRefutation(m_killerMoves.second);
+
+            return pickNextPseudoLegalMove<player>(board);
+        }
+
+        case Counter: {
+            m_phase = PickerPhase::GenerateQuietMoves;
+
+            if (!m_skipQuiets && m_prevMove) {
+                const auto counterMove = m_searchTables.getCounterMove(m_prevMove.value());
+
+                if (isQuietRefutation<player>(board, counterMove))
+                    return pickRefutation(counterMove);
+            }
+
+            return pickNextPseudoLegalMove<player>(board);
+        }
+
+        case GenerateQuietMoves: {
             if (m_skipQuiets) {
                 m_phase = PickerPhase::NoisyBad;
-                return pickNextMove<player>(board);
+                return pickNextPseudoLegalMove<player>(board);
             }
 
-            generateQuietScores<player>(board);
+            generateQuietMoves<player>(board);
 
             m_phase = PickerPhase::QuietMove;
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
         case QuietMove: {
@@ -159,7 +214,7 @@ public:
 
             m_phase = PickerPhase::NoisyBad;
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
         case NoisyBad: {
@@ -168,7 +223,7 @@ public:
 
             m_phase = PickerPhase::Done;
 
-            return pickNextMove<player>(board);
+            return pickNextPseudoLegalMove<player>(board);
         }
 
         case Done:
@@ -178,17 +233,6 @@ public:
         return std::nullopt;
     }
 
-    // Helper: calling inside loops will mean redundant colour checks
-    constexpr std::optional<movegen::Move> pickNextMove(const BitBoard& board)
-    {
-        if (board.player == PlayerWhite) {
-            return pickNextMove<PlayerWhite>(board);
-        } else {
-            return pickNextMove<PlayerBlack>(board);
-        }
-    }
-
-private:
     inline movegen::Move pickMove(uint16_t pos)
     {
         const auto pickedMove = m_moves[pos];
@@ -214,24 +258,40 @@ private:
         return pickedMove;
     }
 
-    constexpr std::optional<movegen::Move> pickTtMove()
+    constexpr std::optional<movegen::Move> pickRefutation(movegen::Move move)
     {
-        if (!m_ttMove.has_value())
-            return std::nullopt;
+        m_refutations[m_refutationCount++] = move;
 
-        for (uint16_t i = 0; i < m_tail; i++) {
-            if (m_moves[i] == *m_ttMove) {
-                m_ttMove.reset();
+        return move;
+    }
 
-                return pickMove(i);
-            }
-        }
-        return std::nullopt;
+    constexpr bool isPickedRefutation(movegen::Move move) const
+    {
+        return std::find(m_refutations.begin(), m_refutations.begin() + m_refutationCount, move) != m_refutations.begin() + m_refutationCount;
     }
 
-    void generateNoisyScores(const BitBoard& board)
+    /* killers and counter moves are stored without the position they were found in */
+    template<Player player>
+    constexpr bool isQuietRefutation(const BitBoard& board, movegen::Move move) const
     {
+        return !isPickedRefutation(move) && core::isPseudoLegal<player, movegen::MoveQuiet>(board, move);
+    }
+
+    void generateNoisyMoves(const BitBoard& board)
+    {
+        /* the full picker generates quiets in a later stage */
+        constexpr auto noisyType = moveType == movegen::MovePseudoLegal ? movegen::MoveNoisy : moveType;
+        core::getAllMoves<noisyType>(board, m_moves);
+        m_tail = m_moves.count();
+
         for (uint16_t i = 0; i < m_tail; i++) {
+            /* the tt move has already been picked */
+            if (isPickedRefutation(m_moves[i])) {
+                pickMove(i);
+                i--;
+                continue;
+            }
+
             if (m_moves[i].isCapture()) {
                 m_scores[i] = evaluation::SeeSwap::getCaptureScore(board, m_moves[i]);
             } else if (m_moves[i].promotionType() == PromotionQueen) {
@@ -274,26 +334,22 @@ private:
         return bestMoveIndex ? std::make_optional(pickMove(bestMoveIndex.value())) : std::nullopt;
     }
 
-    // TODO template over bool hasCounter, to avoid redundant check?
+    /* quiets are appended after the remaining (bad) noisy moves */
     template<Player player>
-    void generateQuietScores(const BitBoard& board)
+    void generateQuietMoves(const BitBoard& board)
     {
-        const auto killerMoves = m_searchTables.getKillerMove(m_ply);
+        movegen::ValidMoves quiets;
+        core::getAllMoves<movegen::MoveQuiet>(board, quiets);
 
-        for (uint16_t i = 0; i < m_tail; i++) {
-            if (!m_moves[i].isQuietMove())
+        for (const auto move : quiets) {
+            if (isPickedRefutation(move))
                 continue;
 
-            if (m_moves[i] == killerMoves.first) {
-                m_scores[i] = MovePickerOffsets::KillerMoveFirst;
-            } else if (m_moves[i] == killerMoves.second) {
-                m_scores[i] = MovePickerOffsets::KillerMoveSecond;
-            } else if (m_prevMove && m_moves[i] == m_searchTables.getCounterMove(m_prevMove.value())) {
-                m_scores[i] = MovePickerOffsets::CounterMove;
-            } else {
-                const auto attacker = board.getAttackerAtSquare<player>(m_moves[i].fromSquare());
-                m_scores[i] = m_searchTables.getHistoryMove(attacker.value(), m_moves[i].toPos());
-            }
+            const auto attacker = board.getAttackerAt<player>(move.fromPos());
+
+            m_moves[m_tail] = move;
+            m_scores[m_tail] = m_searchTables.getHistoryMove(attacker.value(), move.toPos());
+            m_tail++;
         }
     }
 
@@ -324,6 +380,12 @@ private:
     std::optional<movegen::Move> m_prevMove { std::nullopt };
     bool m_skipQuiets { false };
 
+    /* tt move, killers and counter move - picked before the moves are generated */
+    std::array<movegen::Move, 4> m_refutations {};
+    uint8_t m_refutationCount {};
+    std::pair<movegen::Move, movegen::Move> m_killerMoves {};
+    std::optional<core::LegalityInfo> m_legalityInfo {};
+
     movegen::ValidMoves m_moves {};
     std::array<int32_t, s_maxMoves> m_scores {};
     /* Non-syzygy: pick within [0, m_tail), fill gap with last unpicked move, decrease tail */
@@ -4,7 +4,10 @@
 #include "core/thread_pool.h"
 #include "core/time_manager.h"
 #include "core/transposition.h"
+#include "core/tt_overlay.h"
+#include "evaluation/eval_cache.h"
 #include "evaluation/static_evaluation.h"
+#include "nnue/nnue.h"
 #include "search/lmr_table.h"
 #include "search/move_picker.h"
 #include "search/repetition.h"
@@ -15,7 +18,8 @@
 #include "movegen/move_types.h"
 #include "syzygy/syzygy.h"
 
-#include <future>
+#include <atomic>
+#include <mutex>
 
 namespace search {
 
@@ -24,13 +28,45 @@ struct MoveResult {
     BitBoard board;
 };
 
-class Searcher;
-
-struct SearcherResult {
+/* result of the latest completed iteration of a searcher
+ * small enough to be published lock free so the main thread can pick
+ * it up at any time without waiting for the searcher to finish */
+struct SearcherReport {
     Score score;
     movegen::Move pvMove;
-    uint8_t searchedDepth;
-    std::weak_ptr<Searcher> searcher;
+    movegen::Move ponderMove;
+    uint8_t depth;
+    uint8_t reserved; /* pad to 8 bytes to stay lock free */
+};
+
+static_assert(std::atomic<SearcherReport>::is_always_lock_free);
+
+/* the report together with the line it was searched with - too large to be lock free
+ * so it's only copied out when an iteration is voted on and printed */
+struct SearcherPv {
+    SearcherReport report;
+    uint8_t selDepth;
+    uint8_t length;
+    std::array<movegen::Move, s_maxSearchDepth> moves;
+
+    const movegen::Move* begin() const
+    {
+        return moves.begin();
+    }
+
+    const movegen::Move* end() const
+    {
+        return moves.begin() + length;
+    }
+};
+
+/* per searcher diagnostics - tt hits are only counted while the TT tracks writers */
+struct SearcherStats {
+    uint64_t nodes;
+    uint8_t depth;
+    uint8_t selDepth;
+    uint64_t ttHits;
+    uint64_t ttForeignHits; /* entries written by other searchers */
 };
 
 class Searcher : public std::enable_shared_from_this<Searcher> {
@@ -52,14 +88,60 @@ public:
         m_isPrimary = isPrimary;
     }
 
+    void setIndex(std::size_t index)
+    {
+        m_ttWriterId = core::TranspositionTable::writerIdFromIndex(index);
+    }
+
+    /* deterministic mode - TT writes are buffered in an overlay until the evaluator merges them
+     * and the searcher stops itself once it has searched its own node budget */
+    void setDeterministic(bool enabled)
+    {
+        m_ttOverlay.resize(enabled ? s_ttOverlayEntries : 0);
+        m_nodeBudget = 0;
+    }
+
+    bool isDeterministic() const
+    {
+        return m_ttOverlay.isEnabled();
+    }
+
+    /* 0 means no budget */
+    void setNodeBudget(uint64_t nodes)
+    {
+        m_nodeBudget = nodes;
+    }
+
+    bool isOutOfNodes() const
+    {
+        return m_nodeBudget && getNodes() >= m_nodeBudget;
+    }
+
+    /* NOTE: must only be called while no searcher is running */
+    void mergeTtOverlay()
+    {
+        m_ttOverlay.mergeInto(m_ttWriterId);
+    }
+
+    SearcherStats getStats() const
+    {
+        return SearcherStats {
+            .nodes = getNodes(),
+            .depth = getReport().depth,
+            .selDepth = m_selDepth,
+            .ttHits = m_ttHits.load(std::memory_order_relaxed),
+            .ttForeignHits = m_ttForeignHits.load(std::memory_order_relaxed),
+        };
+    }
+
     constexpr uint64_t getNodes() const
     {
-        return m_nodes;
+        return m_nodes.load(std::memory_order_relaxed);
     }
 
     constexpr uint64_t getTbHits() const
     {
-        return m_tbHits;
+        return m_tbHits.load(std::memory_order_relaxed);
     }
 
     constexpr uint64_t getHistoryNodes(movegen::Move move)
@@ -81,40 +163,52 @@ public:
     {
         assert(m_stackItr == m_stack.begin());
 
-        m_stack.front().board = board;
+        setRootBoard(board);
 
         return negamax<true, true>(depth, board, alpha, beta);
     }
 
-    void inline startSearchAsync(ThreadPool& threadPool, uint8_t depth, const BitBoard& board, Score alpha, Score beta)
+    /* publish the result of a completed iteration to the mailbox */
+    void publishReport(uint8_t depth, Score score)
     {
-        assert(m_stackItr == m_stack.begin());
-
-        m_searchPromise = std::promise<SearcherResult> {};
-        m_futureResult = m_searchPromise.get_future();
-
-        m_stack.front().board = board;
-
-        [[maybe_unused]] const bool started = threadPool.submit([this, depth, board, alpha, beta] {
-            SearcherResult result {
-                .score = negamax<true, true>(depth, board, alpha, beta),
-                .pvMove = m_searchTables.getBestPvMove(),
-                .searchedDepth = m_searchTables.getPvSize(),
-                .searcher = weak_from_this()
-            };
-
-            /* Stop any searches going on in other threads, so we're not waiting on the slowest search */
-            setSearchStopped(true);
+        const SearcherReport report {
+            .score = score,
+            .pvMove = m_searchTables.getBestPvMove(),
+            .ponderMove = m_searchTables.getPonderMove(),
+            .depth = depth,
+            .reserved = 0,
+        };
+
+        m_report.store(report, std::memory_order_relaxed);
+
+        const auto& pvTable = m_searchTables.getPvTable();
+        std::lock_guard lock(m_pvMutex);
+
+        m_pv.report = report;
+        m_pv.selDepth = m_selDepth;
+        m_pv.length = std::min<uint8_t>(pvTable.size(), m_pv.moves.size());
+        std::copy(pvTable.begin(), pvTable.begin() + m_pv.length, m_pv.moves.begin());
+    }
 
-            m_searchPromise.set_value(result);
-        });
+    /* latest completed iteration including its pv - the line always starts with the reported move */
+    SearcherPv getPv() const
+    {
+        std::lock_guard lock(m_pvMutex);
+        return m_pv;
+    }
 
-        assert(started);
+    /* latest completed iteration - depth is 0 if no iteration has completed yet */
+    SearcherReport getReport() const
+    {
+        return m_report.load(std::memory_order_relaxed);
     }
 
-    constexpr std::optional<SearcherResult> getSearchResult()
+    void clearReport()
     {
-        return m_futureResult.get();
+        m_report.store(SearcherReport {}, std::memory_order_relaxed);
+
+        std::lock_guard lock(m_pvMutex);
+        m_pv = SearcherPv {};
     }
 
     constexpr movegen::Move getPvMove() const
@@ -133,6 +227,8 @@ public:
         m_stackItr = m_stack.begin();
         m_nodes = 0;
         m_tbHits = 0;
+        m_ttHits = 0;
+        m_ttForeignHits = 0;
         m_selDepth = 0;
         m_searchTables.resetHistoryNodes();
     }
@@ -141,6 +237,7 @@ public:
     {
         m_searchTables.reset();
         m_repetition.reset();
+        m_evalCache.clear();
         resetNodes();
     }
 
@@ -160,12 +257,14 @@ public:
 
         uint8_t depth = depthInput.value_or(5);
 
+        setRootBoard(board);
+
         fmt::println("");
 
         movegen::ValidMoves captures;
         core::getAllMoves<movegen::MoveCapture>(board, captures);
 
-        MovePicker<movegen::MoveCapture> capturePicker { m_searchTables, m_ply, PickerPhase::GenerateMoves };
+        MovePicker<movegen::MoveCapture> capturePicker { m_searchTables, m_ply, PickerPhase::TtMove };
 
         if (captures.count()) {
             fmt::print("Captures[{}]: ", captures.count());
@@ -188,7 +287,7 @@ public:
 
         fmt::println("Move evaluations [{}]:", depth);
 
-        MovePicker<movegen::MovePseudoLegal> allMovesPicker { m_searchTables, m_ply, PickerPhase::GenerateMoves };
+        MovePicker<movegen::MovePseudoLegal> allMovesPicker { m_searchTables, m_ply, PickerPhase::TtMove };
 
         while (const auto& moveOpt = allMovesPicker.pickNextMove(board)) {
             const auto move = moveOpt.value();
@@ -200,7 +299,7 @@ public:
                      "Search score:    {}\n"
                      "PV-line:         {}\n"
                      "Static eval:     {}\n",
-            m_nodes, score, fmt::join(m_searchTables.getPvTable(), " "), m_staticEval.get(board));
+            getNodes(), score, fmt::join(m_searchTables.getPvTable(), " "), evaluate(board));
     }
 
     template<bool isPv, bool isRoot = false>
@@ -215,7 +314,7 @@ public:
             }
         }
 
-        const auto ttProbe = core::TranspositionTable::probe(m_stackItr->board.hash);
+        const auto ttProbe = probeTranspositionTable();
         if constexpr (!isPv && !isRoot) {
             if (ttProbe.has_value()) {
                 const auto testResult = core::testEntry(*ttProbe, m_ply, depth, alpha, beta);
@@ -227,10 +326,10 @@ public:
 
         // Engine is not designed to search deeper than this! Make sure to stop before it's too late
         if (m_ply >= s_maxSearchDepth) {
-            return m_staticEval.get(board);
+            return evaluate(board);
         }
 
-        const bool isChecked = core::isKingAttacked(board);
+        const bool isChecked = board.checkers != 0;
         if (isChecked) {
             /* Dangerous position - increase search depth
              * NOTE: there's rarely many legal moves in this position
@@ -242,7 +341,12 @@ public:
             return quiesence<isPv>(board, alpha, beta);
         }
 
-        m_nodes++;
+        /* don't count nodes past the limit - the result is thrown away when unwinding */
+        if (isSearchStopped()) [[unlikely]] {
+            return s_minScore;
+        }
+
+        incrementCounter(m_nodes);
 
         /* is the position part of the current or a previous PV line? */
         const bool ttPv = isPv || (ttProbe.has_value() && ttProbe->info.pv());
@@ -254,7 +358,7 @@ public:
         } else {
             correction = m_searchTables.getCorrectionHistory(board);
             /* update current stack with the static evaluation */
-            m_stackItr->eval = fetchOrStoreEval(board, ttProbe, ttPv) + correction;
+            m_stackItr->eval = fetchOrStoreEval(board, ttProbe) + correction;
         }
 
         /* improving heuristics -> have the position improved since our last position? */
@@ -316,7 +420,7 @@ public:
             depth--;
         }
 
-        auto phase = PickerPhase::GenerateMoves;
+        auto phase = PickerPhase::TtMove;
 
         if (syzygy::isTableActive(board)) {
             /* generateSyzygyMoves is not thread safe - allow primary searcher only to take this path! */
@@ -325,7 +429,7 @@ public:
             } else if (!isRoot) {
                 const auto wdl = syzygy::probeWdl(board);
                 if (wdl != syzygy::WdlResultFailed) {
-                    m_tbHits++;
+                    incrementCounter(m_tbHits);
                     const auto wdlScore = syzygy::wdlToScore(wdl, m_ply);
                     const auto wdlTtFlag = syzygy::wdlToTtFlag(wdl);
 
@@ -333,7 +437,7 @@ public:
                     if (wdlTtFlag == core::TtExact
                         || (wdlTtFlag == core::TtAlpha && wdlScore <= alpha)
                         || (wdlTtFlag == core::TtBeta && wdlScore >= beta)) {
-                        core::TranspositionTable::writeEntry(m_stackItr->board.hash, wdlScore, s_noScore, movegen::nullMove(), ttPv, depth, m_ply, wdlTtFlag);
+                        writeTranspositionTable(m_stackItr->board.hash, wdlScore, s_noScore, movegen::nullMove(), ttPv, depth, m_ply, wdlTtFlag);
                         return wdlScore;
                     }
 
@@ -401,12 +505,10 @@ public:
                 }
             }
 
-            if (!makeMove(board, move)) {
-                continue;
-            }
+            makeMove(board, move);
 
             Score score = 0;
-            const uint64_t prevNodes = m_nodes;
+            const uint64_t prevNodes = getNodes();
 
             if (movesSearched == 0) {
                 /* no moves searched yet -> perform a full depth PV move search */
@@ -419,7 +521,7 @@ public:
                     && !move.isCapture()
                     && !move.isPromotionMove()) {
 
-                    const bool isGivingCheck = core::isKingAttacked(m_stackItr->board);
+                    const bool isGivingCheck = m_stackItr->board.checkers != 0;
                     reduction = getLmrReduction(depth, movesSearched);
 
                     reduction -= static_cast<int8_t>(isChecked); /* reduce less when checked */
@@ -455,7 +557,7 @@ public:
             movesSearched++;
 
             if (isRoot) {
-                m_searchTables.addHistoryNodes(move, m_nodes - prevNodes);
+                m_searchTables.addHistoryNodes(move, getNodes() - prevNodes);
             }
 
             if (score > bestScore) {
@@ -511,7 +613,7 @@ public:
             m_searchTables.updateHistoryMoves(board, bestMove, m_ply);
         }
 
-        core::TranspositionTable::writeEntry(m_stackItr->board.hash, bestScore, m_stackItr->eval - correction, bestMove, ttPv, depth, m_ply, ttFlag);
+        writeTranspositionTable(m_stackItr->board.hash, bestScore, m_stackItr->eval - correction, bestMove, ttPv, depth, m_ply, ttFlag);
         return bestScore;
     }
 
@@ -524,7 +626,11 @@ private:
     template<bool isPv>
     constexpr Score quiesence(const BitBoard& board, Score alpha, Score beta)
     {
-        m_nodes++;
+        if (isSearchStopped()) [[unlikely]] {
+            return s_minScore;
+        }
+
+        incrementCounter(m_nodes);
         m_selDepth = std::max(m_selDepth, m_ply);
 
         const auto drawScore = checkForDraw(board);
@@ -533,10 +639,10 @@ private:
         }
 
         if (m_ply >= s_maxSearchDepth)
-            return m_staticEval.get(board);
+            return evaluate(board);
 
-        const auto ttProbe = core::TranspositionTable::probe(m_stackItr->board.hash);
-        const bool isChecked = core::isKingAttacked(board);
+        const auto ttProbe = probeTranspositionTable();
+        const bool isChecked = board.checkers != 0;
         const bool ttPv = isPv || (ttProbe.has_value() && ttProbe->info.pv());
 
         Score correction = 0;
@@ -546,7 +652,7 @@ private:
         } else {
             correction = m_searchTables.getCorrectionHistory(board);
             /* update current stack with the static evaluation */
-            m_stackItr->eval = fetchOrStoreEval(board, ttProbe, ttPv) + correction;
+            m_stackItr->eval = fetchOrStoreEval(board, ttProbe) + correction;
         }
 
         /* stand pat */
@@ -576,14 +682,12 @@ private:
         const auto ttMove = tryFetchTtMove(ttProbe);
 
         /* noisy picker auto prunes bad noisy - no need to handle it here */
-        MovePicker<movegen::MoveNoisy> picker { m_searchTables, m_ply, PickerPhase::GenerateMoves, ttMove };
+        MovePicker<movegen::MoveNoisy> picker { m_searchTables, m_ply, PickerPhase::TtMove, ttMove };
 
         while (const auto& moveOpt = picker.pickNextMove(board)) {
             const auto move = moveOpt.value();
 
-            if (!makeMove(board, move)) {
-                continue;
-            }
+            makeMove(board, move);
 
             const Score score = -quiesence<isPv>(m_stackItr->board, -beta, -alpha);
             undoMove();
@@ -608,7 +712,7 @@ private:
             }
         }
 
-        core::TranspositionTable::writeEntry(m_stackItr->board.hash, bestScore, m_stackItr->eval - correction, bestMove, ttPv, 0, m_ply, ttFlag);
+        writeTranspositionTable(m_stackItr->board.hash, bestScore, m_stackItr->eval - correction, bestMove, ttPv, 0, m_ply, ttFlag);
         return bestScore;
     }
 
@@ -631,12 +735,20 @@ private:
         /* enPessant is invalid if we skip move */
         nullMoveBoard.enPessant.reset();
 
+        /* null moves are never made in check - and the opponent can't be in check on our move */
+        nullMoveBoard.checkers = 0;
+
         /* give opponent an extra move */
         nullMoveBoard.player = nextPlayer(nullMoveBoard.player);
 
         m_stackItr += 2;
         m_stackItr->board = nullMoveBoard;
 
+        /* no pieces have moved */
+        if (nnue::Nnue::isEnabled()) {
+            m_stackItr->accumulator = (m_stackItr - 2)->accumulator;
+        }
+
         m_ply += 2;
 
         /* perform search with reduced depth (based on reduction limit) */
@@ -654,13 +766,11 @@ private:
         return std::nullopt;
     }
 
-    bool makeMove(const BitBoard& board, movegen::Move move)
+    /* NOTE: the move must be legal - the move pickers only return legal moves */
+    void makeMove(const BitBoard& board, movegen::Move move)
     {
         auto newBoard = core::performMove(board, move);
-        if (core::isKingAttacked(newBoard, board.player)) {
-            /* invalid move */
-            return false;
-        }
+        assert(!core::isKingAttacked(newBoard, board.player));
 
         /* add current position as potential repetition */
         m_repetition.add(board.hash);
@@ -670,9 +780,11 @@ private:
         m_stackItr->board = std::move(newBoard);
         m_stackItr->move = move;
 
-        m_ply++;
+        if (nnue::Nnue::isEnabled()) {
+            m_stackItr->accumulator.update(nnue::Nnue::getNetwork(), (m_stackItr - 1)->accumulator, board, m_stackItr->board);
+        }
 
-        return true;
+        m_ply++;
     }
 
     void undoMove()
@@ -693,16 +805,71 @@ private:
     }
 
     /* try to fetch the static evaluation from the TT entry, if any
-     * otherwise compute the static evaluation based on the current board
-     * position - and then try to update the TT with that evaluation  */
-    inline Score fetchOrStoreEval(const BitBoard& board, std::optional<core::TtEntryData> entry, bool ttPv)
+     * otherwise look it up in the eval cache or compute it based on the current board
+     * position - the eval cache is private to this searcher so eval-only results
+     * never take up TT slots or cause cache line contention between threads */
+    inline Score fetchOrStoreEval(const BitBoard& board, std::optional<core::TtEntryData> entry)
     {
         if (entry.has_value() && entry->eval != s_noScore) {
             return entry->eval;
+        }
+
+        if (const auto cached = m_evalCache.probe(board.hash)) {
+            return *cached;
+        }
+
+        const Score eval = evaluate(board);
+        m_evalCache.write(board.hash, eval);
+        return eval;
+    }
+
+    /* static evaluation from the selected backend - seen from the player to move */
+    inline Score evaluate(const BitBoard& board)
+    {
+        if (nnue::Nnue::isEnabled()) {
+            return nnue::Nnue::evaluate(m_stackItr->accumulator, board.player);
+        }
+
+        return m_staticEval.get(board);
+    }
+
+    void setRootBoard(const BitBoard& board)
+    {
+        m_stack.front().board = board;
+
+        if (nnue::Nnue::isEnabled()) {
+            m_stack.front().accumulator.refresh(nnue::Nnue::getNetwork(), board);
+        }
+    }
+
+    inline std::optional<core::TtEntryData> probeTranspositionTable()
+    {
+        /* own writes in deterministic mode are still in the overlay */
+        if (m_ttOverlay.isEnabled()) [[unlikely]] {
+            if (const auto overlayProbe = m_ttOverlay.probe(m_stackItr->board.hash)) {
+                return overlayProbe;
+            }
+        }
+
+        const auto ttProbe = core::TranspositionTable::probe(m_stackItr->board.hash);
+
+        if (core::TranspositionTable::isTrackingWriters() && ttProbe.has_value()) [[unlikely]] {
+            incrementCounter(m_ttHits);
+
+            if (core::TranspositionTable::getWriter(m_stackItr->board.hash) != m_ttWriterId) {
+                incrementCounter(m_ttForeignHits);
+            }
+        }
+
+        return ttProbe;
+    }
+
+    inline void writeTranspositionTable(uint64_t key, Score score, Score eval, movegen::Move move, bool ttPv, uint8_t depth, uint8_t ply, core::TtFlag flag)
+    {
+        if (m_ttOverlay.isEnabled()) [[unlikely]] {
+            m_ttOverlay.writeEntry(key, score, eval, move, ttPv, depth, ply, flag);
         } else {
-            const Score eval = m_staticEval.get(board);
-            core::TranspositionTable::writeEntry(m_stackItr->board.hash, s_noScore, eval, movegen::nullMove(), ttPv, 0, m_ply, core::TtAlpha);
-            return eval;
+            core::TranspositionTable::writeEntry(key, score, eval, move, ttPv, depth, ply, flag, m_ttWriterId);
         }
     }
 
@@ -711,18 +878,31 @@ private:
         if (s_searchStopped.load(std::memory_order_relaxed))
             return true;
 
-        if (m_isPrimary && m_nodes % 2048 == 0) {
-            TimeManager::updateTimeout();
+        /* deterministic - other searchers must not be able to stop this one at a random point */
+        if (m_ttOverlay.isEnabled()) [[unlikely]] {
+            return isOutOfNodes() || TimeManager::hasTimedOut();
+        }
+
+        /* time is handled by the timer thread - only the node limit needs checking
+         * the check is cheap so do it on every node to not overshoot 'go nodes' */
+        if (m_isPrimary) {
+            TimeManager::updateNodeLimit(getNodes());
         }
 
         return TimeManager::hasTimedOut();
     }
 
+    /* counters are only ever written by the owning thread - avoid a locked increment */
+    static inline void incrementCounter(std::atomic<uint64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
     inline std::optional<Score> checkForDraw(const BitBoard& board)
     {
         const bool isDraw = board.halfMoves >= 100 || m_repetition.isRepetition(board, m_stackItr->board.hash, m_ply) || board.hasInsufficientMaterial();
         if (isDraw) {
-            return m_staticEval.getDrawScore(m_nodes, m_ply);
+            return m_staticEval.getDrawScore(getNodes(), m_ply);
         }
 
         return std::nullopt;
@@ -731,26 +911,39 @@ private:
     static inline uint8_t s_numSearchers {};
     static inline std::atomic_bool s_searchStopped { true };
 
-    uint64_t m_nodes {};
-    uint64_t m_tbHits {};
+    /* counters are read by the main thread while searching */
+    std::atomic<uint64_t> m_nodes {};
+    std::atomic<uint64_t> m_tbHits {};
+    std::atomic<uint64_t> m_ttHits {};
+    std::atomic<uint64_t> m_ttForeignHits {};
     uint8_t m_ply {};
     Repetition m_repetition;
     SearchTables m_searchTables {};
     uint8_t m_selDepth {};
     bool m_isPrimary { true };
+    uint8_t m_ttWriterId { core::TranspositionTable::writerIdFromIndex(0) };
+    uint64_t m_nodeBudget {};
+    core::TtOverlay m_ttOverlay;
+
+    /* 16 bytes per entry - 4MB */
+    constexpr static inline std::size_t s_ttOverlayEntries { 1 << 18 };
 
     struct StackInfo {
         BitBoard board;
         movegen::Move move;
         Score eval;
+        nnue::Accumulator accumulator;
     };
 
     std::array<StackInfo, s_maxSearchDepth> m_stack;
     decltype(m_stack)::iterator m_stackItr = m_stack.begin();
 
-    std::promise<SearcherResult> m_searchPromise;
-    std::future<SearcherResult> m_futureResult;
+    std::atomic<SearcherReport> m_report {};
+
+    mutable std::mutex m_pvMutex;
+    SearcherPv m_pv {};
 
     evaluation::StaticEvaluation m_staticEval;
+    evaluation::EvalCache m_evalCache;
 };
 }
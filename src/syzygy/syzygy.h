@@ -184,6 +184,37 @@ inline void printDtzDebug(const BitBoard& board)
     }
 }
 
+/* converts a single probe result to a move of the player to move - nullopt if it doesn't match the board */
+inline std::optional<movegen::Move> resultToMove(const BitBoard& board, uint32_t res)
+{
+    const auto from = magic_enum::enum_cast<BoardPosition>(TB_GET_FROM(res));
+    const auto to = magic_enum::enum_cast<BoardPosition>(TB_GET_TO(res));
+
+    if (!from.has_value() || !to.has_value())
+        return std::nullopt;
+
+    const auto attacker = board.getAttackerAt(*from, board.player);
+    if (!attacker.has_value())
+        return std::nullopt;
+
+    const bool isCapture = board.getTargetAt(*to, board.player).has_value();
+
+    switch (TB_GET_PROMOTES(res)) {
+    case TB_PROMOTES_NONE:
+        return movegen::Move::create(*from, *to, isCapture);
+    case TB_PROMOTES_QUEEN:
+        return movegen::Move::createPromotion(*from, *to, PromotionQueen, isCapture);
+    case TB_PROMOTES_ROOK:
+        return movegen::Move::createPromotion(*from, *to, PromotionRook, isCapture);
+    case TB_PROMOTES_BISHOP:
+        return movegen::Move::createPromotion(*from, *to, PromotionBishop, isCapture);
+    case TB_PROMOTES_KNIGHT:
+        return movegen::Move::createPromotion(*from, *to, PromotionKnight, isCapture);
+    }
+
+    return std::nullopt;
+}
+
 /* NOTE: this method is not thread safe (tb_probe_root is declared as non-thread safe)
  * NOTE: this method should only be called once from root */
 inline bool generateSyzygyMoves(const BitBoard& board, movegen::ValidMoves& moves)
@@ -200,35 +231,8 @@ inline bool generateSyzygyMoves(const BitBoard& board, movegen::ValidMoves& move
 
     const auto sortedResults = sortDtzResults(results, TB_GET_WDL(res));
     for (const uint32_t res : sortedResults) {
-        const auto from = magic_enum::enum_cast<BoardPosition>(TB_GET_FROM(res));
-        const auto to = magic_enum::enum_cast<BoardPosition>(TB_GET_TO(res));
-
-        if (!from.has_value() || !to.has_value())
-            continue;
-
-        const auto attacker = board.getAttackerAtSquare(utils::positionToSquare(*from), board.player);
-        const auto target = board.getTargetAtSquare(utils::positionToSquare(*to), board.player);
-        if (!attacker.has_value())
-            continue;
-
-        const bool isCapture = target.has_value();
-
-        switch (TB_GET_PROMOTES(res)) {
-        case TB_PROMOTES_NONE:
-            moves.addMove(movegen::Move::create(*from, *to, isCapture));
-            break;
-        case TB_PROMOTES_QUEEN:
-            moves.addMove(movegen::Move::createPromotion(*from, *to, PromotionQueen, isCapture));
-            break;
-        case TB_PROMOTES_ROOK:
-            moves.addMove(movegen::Move::createPromotion(*from, *to, PromotionRook, isCapture));
-            break;
-        case TB_PROMOTES_BISHOP:
-            moves.addMove(movegen::Move::createPromotion(*from, *to, PromotionBishop, isCapture));
-            break;
-        case TB_PROMOTES_KNIGHT:
-            moves.addMove(movegen::Move::createPromotion(*from, *to, PromotionKnight, isCapture));
-            break;
+        if (const auto move = resultToMove(board, res)) {
+            moves.addMove(*move);
         }
     }
 
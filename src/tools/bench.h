@@ -1,25 +1,471 @@
 #pragma once
 
 #include "evaluation/evaluator.h"
+#include "interface/outputs.h"
+#include "nnue/nnue.h"
 #include "parsing/fen_parser.h"
+#include "parsing/input_parsing.h"
 
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
+#include <ranges>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 namespace tools {
 
 class Bench {
 public:
-    static void run(evaluation::Evaluator& evaluator, uint8_t depth = s_defaultSearchDepth)
+    /* the default options must stay fixed - the node count is used to verify commits */
+    struct Options {
+        uint8_t depth { s_defaultSearchDepth };
+        std::optional<uint64_t> nodes {}; /* per position - replaces the depth limit */
+        std::optional<uint64_t> moveTime {}; /* per position in ms - replaces the depth limit */
+        std::optional<std::size_t> threads {}; /* 1 by default - scaling defaults to all cores */
+        std::size_t hashSizeMb { s_defaultHashSizeMb };
+        bool json { false };
+        bool deterministic { false }; /* nodes becomes a budget per thread */
+    };
+
+    /* [<depth>] [depth <n>] [nodes <n>] [movetime <ms>] [threads <n>] [hash <mb>] [json] [deterministic] */
+    static std::optional<Options> parseOptions(std::string_view args)
+    {
+        Options options {};
+        bool firstSetting = true;
+
+        while (!args.empty()) {
+            const auto [setting, settingArgs] = parsing::split_sv_by_space(args);
+            args = settingArgs;
+
+            if (setting == "json") {
+                options.json = true;
+                firstSetting = false;
+                continue;
+            } else if (setting == "deterministic") {
+                options.deterministic = true;
+                firstSetting = false;
+                continue;
+            }
+
+            /* plain 'bench <depth>' is kept for compatibility */
+            const bool plainDepth = std::exchange(firstSetting, false) && parsing::to_number(setting).has_value();
+
+            /* settings with values */
+            std::string_view value = setting;
+            if (!plainDepth) {
+                std::tie(value, args) = parsing::split_sv_by_space(args);
+            }
+
+            const auto valNum = parsing::to_number(value);
+            if (!valNum.has_value() || *valNum < 1) {
+                return std::nullopt;
+            }
+
+            if ((plainDepth || setting == "depth") && *valNum <= s_maxSearchDepth) {
+                options.depth = *valNum;
+            } else if (setting == "nodes") {
+                options.nodes = *valNum;
+            } else if (setting == "movetime") {
+                options.moveTime = *valNum;
+            } else if (setting == "threads" && *valNum <= static_cast<int64_t>(s_maxThreads)) {
+                options.threads = *valNum;
+            } else if (setting == "hash" && *valNum <= static_cast<int64_t>(s_maxTtSizeMb)) {
+                options.hashSizeMb = *valNum;
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        return options;
+    }
+
+    static void run(evaluation::Evaluator& evaluator)
+    {
+        run(evaluator, Options {});
+    }
+
+    static void run(evaluation::Evaluator& evaluator, const Options& options)
+    {
+        const std::size_t previousHashSize = core::TranspositionTable::getSizeMb();
+        const std::size_t previousThreads = evaluator.getNumSearchers();
+        const bool wasDeterministic = evaluator.isDeterministic();
+        const std::size_t threads = options.threads.value_or(1);
+
+        evaluator.resizeSearchers(threads);
+        evaluator.setHashSizeMb(options.hashSizeMb);
+        evaluator.setDeterministic(options.deterministic);
+
+        if (options.json) {
+            interface::setSearchInfoEnabled(false);
+        } else {
+            fmt::println("Bench [{}, threads {}, hash {}MB{}]\n", limitToString(options), threads, options.hashSizeMb, options.deterministic ? ", deterministic" : "");
+        }
+
+        const auto result = searchPositions(evaluator, options, options.json ? Output::Json : Output::Text);
+
+        interface::setSearchInfoEnabled(true);
+        evaluator.setDeterministic(wasDeterministic);
+        evaluator.resizeSearchers(previousThreads);
+
+        if (previousHashSize > 0) {
+            evaluator.setHashSizeMb(previousHashSize);
+        }
+
+        if (!result.has_value()) {
+            return;
+        }
+
+        if (options.json) {
+            fmt::println(R"({{"type":"summary","positions":{},{},"threads":{},"hash_mb":{},"deterministic":{},"nodes":{},"time_ms":{:.1f},"nps":{:.0f}}})",
+                s_benchPositions.size(), limitToJson(options), threads, options.hashSizeMb, options.deterministic, result->nodes, result->seconds * 1000, result->nps());
+            return;
+        }
+
+        fmt::println("==========================\n"
+                     "Total time: {:.2f} seconds\n"
+                     "OpenBench result:",
+            result->seconds);
+
+        /* OpenBench expects this format */
+        fmt::println("{} nodes {:.0f} nps", result->nodes, result->nps());
+    }
+
+    /* runs the bench positions with 1, 2, 4.. and up to the max amount of threads
+     * reports time to depth, nps, how evenly the searchers are loaded and how much
+     * the searchers benefit from each others TT entries */
+    static void runScaling(evaluation::Evaluator& evaluator, const Options& options)
+    {
+        if (options.nodes.has_value() || options.moveTime.has_value()) {
+            fmt::println("Scaling is measured as time to depth - only a depth limit is supported");
+            return;
+        }
+
+        const std::size_t previousHashSize = core::TranspositionTable::getSizeMb();
+        const std::size_t previousThreads = evaluator.getNumSearchers();
+        const std::size_t maxThreads = std::clamp<std::size_t>(options.threads.value_or(std::thread::hardware_concurrency()), 1, s_maxThreads);
+
+        fmt::println("Bench scaling [depth {}, max threads {}, hash {}MB]", options.depth, maxThreads, options.hashSizeMb);
+
+        evaluator.setHashSizeMb(options.hashSizeMb);
+        core::TranspositionTable::setTrackWriters(true);
+        interface::setSearchInfoEnabled(false);
+
+        std::optional<double> singleThreadSeconds;
+        for (std::size_t threads = 1; threads <= maxThreads; threads = threads == maxThreads ? maxThreads + 1 : std::min(threads * 2, maxThreads)) {
+            evaluator.resizeSearchers(threads);
+            evaluator.clearHashTable();
+
+            const auto result = searchPositions(evaluator, options, Output::Quiet);
+            if (!result.has_value()) {
+                break;
+            }
+
+            if (!singleThreadSeconds.has_value()) {
+                singleThreadSeconds = result->seconds;
+            }
+
+            printScalingResult(threads, *result, *singleThreadSeconds);
+        }
+
+        interface::setSearchInfoEnabled(true);
+        core::TranspositionTable::setTrackWriters(false);
+        evaluator.resizeSearchers(previousThreads);
+
+        if (previousHashSize > 0) {
+            evaluator.setHashSizeMb(previousHashSize);
+        }
+    }
+
+    /* measures how long it takes from a search being stopped until bestmove is ready
+     * every bench position is searched twice per thread count:
+     * - stopped: an infinite search is stopped at a random point, like a GUI sending 'stop'
+     * - timeout: a movetime search runs into its deadline (searches that finish early are skipped)
+     * the stop points are random but seeded so runs are comparable */
+    static void runLatency(evaluation::Evaluator& evaluator, const Options& options)
     {
-        s_nodesCount = 0;
+        const std::size_t previousHashSize = core::TranspositionTable::getSizeMb();
+        const std::size_t previousThreads = evaluator.getNumSearchers();
+        const std::size_t maxThreads = std::clamp<std::size_t>(options.threads.value_or(std::thread::hardware_concurrency()), 1, s_maxThreads);
+
+        fmt::println("Bench latency [max threads {}, hash {}MB, stop after {}-{}ms]",
+            maxThreads, options.hashSizeMb, s_latencyMinStopMs, s_latencyMaxStopMs);
+
+        evaluator.setHashSizeMb(options.hashSizeMb);
+        interface::setSearchInfoEnabled(false);
+
+        for (std::size_t threads = 1; threads <= maxThreads; threads = threads == maxThreads ? maxThreads + 1 : std::min(threads * 2, maxThreads)) {
+            evaluator.resizeSearchers(threads);
+            evaluator.clearHashTable();
+
+            std::mt19937 rng(s_latencySeed);
+            std::uniform_int_distribution<uint64_t> stopAfterMs(s_latencyMinStopMs, s_latencyMaxStopMs);
+
+            LatencySamples stopped, timeout;
+            for (const auto position : s_benchPositions) {
+                const auto board = parsing::FenParser::parse(position);
+                if (!board.has_value()) {
+                    fmt::println("Invalid fen: {}, aborting", position);
+                    break;
+                }
+
+                measureStopped(evaluator, *board, std::chrono::milliseconds(stopAfterMs(rng)), stopped);
+                measureTimeout(evaluator, *board, stopAfterMs(rng), timeout);
+            }
+
+            fmt::println("\nThreads {}:", threads);
+            printLatency("stopped", stopped);
+            printLatency("timeout", timeout);
+        }
+
+        interface::setSearchInfoEnabled(true);
+        evaluator.resizeSearchers(previousThreads);
+
+        if (previousHashSize > 0) {
+            evaluator.setHashSizeMb(previousHashSize);
+        }
+    }
+
+    /* compares the NNUE backend against the hand crafted evaluation on the bench positions
+     * both the search speed and how well the static evaluations agree are reported */
+    static void compareNnue(evaluation::Evaluator& evaluator, uint8_t depth = s_defaultSearchDepth)
+    {
+        const bool wasEnabled = nnue::Nnue::isEnabled();
+        if (!nnue::Nnue::setEnabled(true)) {
+            fmt::println("NNUE is not available - nothing to compare");
+            return;
+        }
 
         const std::size_t previousHashSize = core::TranspositionTable::getSizeMb();
+        evaluator.setHashSizeMb(s_defaultHashSizeMb);
+
+        /* static evaluations seen from the player to move */
+        auto staticEval = std::make_unique<evaluation::StaticEvaluation>();
+        auto accumulator = std::make_unique<nnue::Accumulator>();
+
+        double sumHce {}, sumNnue {}, sumHce2 {}, sumNnue2 {}, sumProduct {}, sumAbsDiff {};
+        std::size_t sameSign {};
+
+        for (const auto position : s_benchPositions) {
+            const auto board = parsing::FenParser::parse(position).value();
+
+            accumulator->refresh(nnue::Nnue::getNetwork(), board);
+            const double hceEval = staticEval->get(board);
+            const double nnueEval = nnue::Nnue::evaluate(*accumulator, board.player);
+
+            sumHce += hceEval;
+            sumNnue += nnueEval;
+            sumHce2 += hceEval * hceEval;
+            sumNnue2 += nnueEval * nnueEval;
+            sumProduct += hceEval * nnueEval;
+            sumAbsDiff += std::abs(hceEval - nnueEval);
+            sameSign += (hceEval >= 0) == (nnueEval >= 0);
+        }
+
+        const double n = s_benchPositions.size();
+        const double covariance = sumProduct / n - (sumHce / n) * (sumNnue / n);
+        const double deviations = std::sqrt((sumHce2 / n - std::pow(sumHce / n, 2)) * (sumNnue2 / n - std::pow(sumNnue / n, 2)));
+        const double correlation = deviations > 0 ? covariance / deviations : 0;
 
-        /* lots of different positions - use a fairly universal size
-         * FIXME: add hash size as an optional argument */
-        core::TranspositionTable::setSizeMb(128);
+        const Options options { .depth = depth };
+
+        /* the TT stores static evaluations - never let one backend use the other's */
+        nnue::Nnue::setEnabled(false);
+        evaluator.clearHashTable();
+        const auto hceResult = searchPositions(evaluator, options, Output::Quiet);
+
+        nnue::Nnue::setEnabled(true);
+        evaluator.clearHashTable();
+        const auto nnueResult = searchPositions(evaluator, options, Output::Quiet);
+
+        nnue::Nnue::setEnabled(wasEnabled);
+        evaluator.clearHashTable();
+
+        if (hceResult.has_value() && nnueResult.has_value()) {
+            fmt::println("Search [depth {}]:\n"
+                         "  hand crafted:  {} nodes {:.0f} nps\n"
+                         "  nnue:          {} nodes {:.0f} nps ({})\n"
+                         "  nps ratio:     {:.2f}\n",
+                depth,
+                hceResult->nodes, hceResult->nps(),
+                nnueResult->nodes, nnueResult->nps(), nnue::simd::simdPathToString(nnue::simd::s_simdPath),
+                nnueResult->nps() / hceResult->nps());
+        }
+
+        fmt::println("Static evaluation agreement [{} positions]:\n"
+                     "  mean abs diff: {:.1f} cp\n"
+                     "  same sign:     {:.1f}%\n"
+                     "  correlation:   {:.3f}",
+            s_benchPositions.size(), sumAbsDiff / n, 100.0 * sameSign / n, correlation);
+
+        if (previousHashSize > 0) {
+            evaluator.setHashSizeMb(previousHashSize);
+        }
+    }
+
+private:
+    enum class Output {
+        Quiet,
+        Text,
+        Json,
+    };
+
+    /* searcher stats summed over all positions */
+    struct SearcherTotals {
+        uint64_t nodes;
+        uint64_t depths;
+        uint64_t ttHits;
+        uint64_t ttForeignHits;
+    };
+
+    struct SearchResult {
+        uint64_t nodes;
+        double seconds;
+        std::vector<SearcherTotals> searchers;
+        uint64_t depthSpreads; /* deepest minus shallowest searcher - summed over all positions */
+        uint8_t maxDepthSpread;
+
+        double nps() const
+        {
+            return nodes / seconds;
+        }
+    };
+
+    static void printScalingResult(std::size_t threads, const SearchResult& result, double singleThreadSeconds)
+    {
+        uint64_t ttHits {}, ttForeignHits {};
+        for (const auto& searcher : result.searchers) {
+            ttHits += searcher.ttHits;
+            ttForeignHits += searcher.ttForeignHits;
+        }
+
+        const double positions = s_benchPositions.size();
+
+        fmt::println("\nThreads {}:\n"
+                     "  time to depth:  {:.2f}s (speedup {:.2f}x)\n"
+                     "  nps:            {:.0f} ({:.0f} per thread)\n"
+                     "  depth spread:   {:.2f} avg, {} max\n"
+                     "  tt hits:        {} ({:.1f}% written by other threads)",
+            threads,
+            result.seconds, singleThreadSeconds / result.seconds,
+            result.nps(), result.nps() / threads,
+            result.depthSpreads / positions, result.maxDepthSpread,
+            ttHits, ttHits ? 100.0 * ttForeignHits / ttHits : 0.0);
+
+        fmt::println("  searcher   nodes        nps          avg depth   tt hits      other threads");
+        for (std::size_t i = 0; i < result.searchers.size(); i++) {
+            const auto& searcher = result.searchers[i];
+            fmt::println("  {:<10} {:<12} {:<12.0f} {:<11.2f} {:<12} {:.1f}%",
+                i, searcher.nodes, searcher.nodes / result.seconds, searcher.depths / positions, searcher.ttHits,
+                searcher.ttHits ? 100.0 * searcher.ttForeignHits / searcher.ttHits : 0.0);
+        }
+    }
+
+    /* latencies in microseconds - measured until the primary returned its move and until
+     * all helpers were joined and bestmove could be printed */
+    struct LatencySamples {
+        std::vector<double> primary;
+        std::vector<double> bestMove;
+        std::size_t skipped {};
+
+        void add(TimePoint stopTime, const evaluation::Evaluator::SearchTimestamps& timestamps)
+        {
+            using namespace std::chrono;
+
+            /* the search finished on its own before it was stopped */
+            if (timestamps.helpersDone < stopTime) {
+                skipped++;
+                return;
+            }
+
+            primary.push_back(duration_cast<duration<double, std::micro>>(timestamps.primaryDone - stopTime).count());
+            bestMove.push_back(duration_cast<duration<double, std::micro>>(timestamps.helpersDone - stopTime).count());
+        }
+    };
+
+    static void measureStopped(evaluation::Evaluator& evaluator, const BitBoard& board, std::chrono::milliseconds stopAfter, LatencySamples& samples)
+    {
+        evaluator.reset();
+
+        /* a depth limited search is infinite in time - it runs until stopped
+         * so the stop must not land before the search has reset its state */
+        const uint64_t searchesStarted = evaluator.getSearchesStarted();
+        std::jthread search([&evaluator, &board] { std::ignore = evaluator.getBestMove(board, s_maxSearchDepth); });
+        evaluator.waitForSearchStarted(searchesStarted);
+
+        std::this_thread::sleep_for(stopAfter);
+
+        const auto stopTime = std::chrono::steady_clock::now();
+        evaluator.stop();
+        search.join();
+
+        samples.add(stopTime, evaluator.getSearchTimestamps());
+    }
+
+    static void measureTimeout(evaluation::Evaluator& evaluator, const BitBoard& board, uint64_t moveTime, LatencySamples& samples)
+    {
+        evaluator.reset();
+        TimeManager::setMoveTime(moveTime);
+
+        std::ignore = evaluator.getBestMove(board);
+
+        /* the deadline is cleared once it has fired - the start of the search is the one from the time manager */
+        samples.add(TimeManager::getStartTime() + std::chrono::milliseconds(moveTime), evaluator.getSearchTimestamps());
+    }
+
+    /* nearest rank percentile */
+    static double percentile(std::vector<double> values, double fraction)
+    {
+        if (values.empty()) {
+            return 0.0;
+        }
+
+        std::ranges::sort(values);
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * values.size()));
+        return values[std::clamp<std::size_t>(rank, 1, values.size()) - 1];
+    }
+
+    static void printLatency(std::string_view name, const LatencySamples& samples)
+    {
+        fmt::println("  {:<8} samples {:<3} skipped {:<3} bestmove p50 {:>8.1f}us  p99 {:>8.1f}us  max {:>8.1f}us  (primary p50 {:.1f}us p99 {:.1f}us)",
+            name, samples.bestMove.size(), samples.skipped,
+            percentile(samples.bestMove, 0.5), percentile(samples.bestMove, 0.99), percentile(samples.bestMove, 1.0),
+            percentile(samples.primary, 0.5), percentile(samples.primary, 0.99));
+    }
+
+    static std::string limitToString(const Options& options)
+    {
+        if (options.nodes.has_value()) {
+            return fmt::format("nodes {}", *options.nodes);
+        } else if (options.moveTime.has_value()) {
+            return fmt::format("movetime {}ms", *options.moveTime);
+        }
+
+        return fmt::format("depth {}", options.depth);
+    }
+
+    /* the limit as json key/value pairs */
+    static std::string limitToJson(const Options& options)
+    {
+        if (options.nodes.has_value()) {
+            return fmt::format(R"("limit":"nodes","limit_value":{})", *options.nodes);
+        } else if (options.moveTime.has_value()) {
+            return fmt::format(R"("limit":"movetime","limit_value":{})", *options.moveTime);
+        }
+
+        return fmt::format(R"("limit":"depth","limit_value":{})", options.depth);
+    }
+
+    static std::optional<SearchResult> searchPositions(evaluation::Evaluator& evaluator, const Options& options, Output output)
+    {
+        uint64_t nodes = 0;
+        std::vector<SearcherTotals> searchers(evaluator.getNumSearchers());
+        uint64_t depthSpreads = 0;
+        uint8_t maxDepthSpread = 0;
 
         using namespace std::chrono;
         const auto startTime = steady_clock::now();
@@ -30,42 +476,81 @@ public:
 
             if (!board.has_value()) {
                 fmt::println("Invalid fen: {}, aborting", position);
-                return;
+                return std::nullopt;
             }
 
-            fmt::println("Position {}/{} [{}]", ++count, s_benchPositions.size(), position);
+            count++;
+            if (output == Output::Text) {
+                fmt::println("Position {}/{} [{}]", count, s_benchPositions.size(), position);
+            }
 
+            /* the time manager is reset as well - limits must be set afterwards */
             evaluator.reset();
-            const auto bestMove = evaluator.getBestMove(*board, depth);
 
-            s_nodesCount += evaluator.getNodes();
+            const auto positionStartTime = steady_clock::now();
+            movegen::Move bestMove;
 
-            fmt::println("bestmove {}\n", bestMove);
-        }
+            if (options.nodes.has_value() || options.moveTime.has_value()) {
+                if (options.nodes.has_value()) {
+                    TimeManager::setNodeLimit(*options.nodes);
+                } else {
+                    TimeManager::setMoveTime(*options.moveTime);
+                }
 
-        const auto endTime = steady_clock::now();
-        /* time in seconds reflected as a double */
-        const auto timeDiff = duration_cast<duration<double>>(endTime - startTime).count();
-        const double nps = s_nodesCount / timeDiff;
+                bestMove = evaluator.getBestMove(*board);
+            } else {
+                bestMove = evaluator.getBestMove(*board, options.depth);
+            }
 
-        fmt::println("==========================\n"
-                     "Total time: {:.2f} seconds\n"
-                     "OpenBench result:",
-            timeDiff);
+            const double seconds = duration_cast<duration<double>>(steady_clock::now() - positionStartTime).count();
+            const uint64_t positionNodes = evaluator.getNodes();
+            nodes += positionNodes;
 
-        /* OpenBench expects this format */
-        fmt::println("{} nodes {:.0f} nps", s_nodesCount, nps);
+            const auto stats = evaluator.getSearcherStats();
+            const auto [minDepth, maxDepth] = std::ranges::minmax(stats | std::views::transform(&search::SearcherStats::depth));
+            depthSpreads += maxDepth - minDepth;
+            maxDepthSpread = std::max<uint8_t>(maxDepthSpread, maxDepth - minDepth);
 
-        if (previousHashSize > 0) {
-            core::TranspositionTable::setSizeMb(previousHashSize);
+            for (std::size_t i = 0; i < stats.size(); i++) {
+                searchers[i].nodes += stats[i].nodes;
+                searchers[i].depths += stats[i].depth;
+                searchers[i].ttHits += stats[i].ttHits;
+                searchers[i].ttForeignHits += stats[i].ttForeignHits;
+            }
+
+            if (output == Output::Text) {
+                fmt::println("bestmove {} nodes {} time {:.0f}ms nps {:.0f} depth {} seldepth {}\n",
+                    bestMove, positionNodes, seconds * 1000, positionNodes / seconds, evaluator.getDepth(), evaluator.getSelDepth());
+            } else if (output == Output::Json) {
+                fmt::println(R"({{"type":"position","position":{},"fen":"{}","bestmove":"{}","nodes":{},"time_ms":{:.1f},"nps":{:.0f},"depth":{},"seldepth":{}}})",
+                    count, position, bestMove, positionNodes, seconds * 1000, positionNodes / seconds, evaluator.getDepth(), evaluator.getSelDepth());
+            }
         }
+
+        const auto endTime = steady_clock::now();
+
+        /* time in seconds reflected as a double */
+        return SearchResult {
+            .nodes = nodes,
+            .seconds = duration_cast<duration<double>>(endTime - startTime).count(),
+            .searchers = std::move(searchers),
+            .depthSpreads = depthSpreads,
+            .maxDepthSpread = maxDepthSpread,
+        };
     }
 
-private:
-    static inline uint64_t s_nodesCount {};
     constexpr static inline uint8_t s_defaultSearchDepth { 10 };
 
-    /* commonly used bench positions */
+    /* range of the random stop points of the latency bench */
+    constexpr static inline uint64_t s_latencyMinStopMs { 5 };
+    constexpr static inline uint64_t s_latencyMaxStopMs { 100 };
+    constexpr static inline uint32_t s_latencySeed { 1337 };
+
+    /* lots of different positions - use a fairly universal size */
+    constexpr static inline std::size_t s_defaultHashSizeMb { 128 };
+
+public:
+    /* commonly used bench positions - also used by the micro benchmarks */
     constexpr static inline auto s_benchPositions = std::to_array<std::string_view>({
         "r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14",
         "4rrk1/2p1b1p1/p1p3q1/4p3/2P2n1p/1P1NR2P/PB3PP1/3R1QK1 b - - 2 24",
@@ -2,7 +2,14 @@
 
 #include "core/bit_board.h"
 #include "core/move_handling.h"
+#include "core/work_stealing_pool.h"
+#include "parsing/fen_parser.h"
+#include <atomic>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <vector>
 
 #include "utils/formatters.h"
 
@@ -10,6 +17,159 @@ namespace tools {
 
 class Perft {
 public:
+    constexpr static inline std::size_t s_defaultThreads { 1 };
+    constexpr static inline std::size_t s_defaultHashSizeMb { 64 };
+    constexpr static inline uint8_t s_maxSuiteDepth { std::numeric_limits<uint8_t>::max() };
+
+    /* fast perft - the first plies are split into jobs on a work stealing pool, subtree counts
+     * are cached in a hash table and moves at depth 1 are bulk counted instead of recursed into
+     * returns the total amount of nodes */
+    static uint64_t runParallel(const BitBoard& board, uint8_t depth, std::size_t threads = s_defaultThreads, std::size_t hashSizeMb = s_defaultHashSizeMb)
+    {
+        fmt::print("*** Starting perft - depth {}, threads {}, hash {}MB ***\n", depth, threads, hashSizeMb);
+
+        using namespace std::chrono;
+        const auto startTime = steady_clock::now();
+
+        movegen::ValidMoves rootMoves;
+        core::getLegalMoves<movegen::MovePseudoLegal>(board, rootMoves);
+        std::vector<uint64_t> rootNodes(rootMoves.count());
+
+        if (depth == 0) {
+            rootNodes = { 1 };
+        } else if (depth == 1) {
+            rootNodes.assign(rootMoves.count(), 1);
+        } else {
+            HashTable hashTable(hashSizeMb);
+            WorkStealingPool pool(threads);
+            std::vector<WorkStealingPool::Future<uint64_t>> futures;
+
+            for (const auto move : rootMoves) {
+                futures.push_back(pool.submit(searchSplit, std::ref(pool), core::performMove(board, move), depth - 1, std::ref(hashTable), s_splitPlies));
+            }
+
+            for (std::size_t i = 0; i < futures.size(); i++) {
+                rootNodes[i] = pool.get(futures[i]);
+            }
+        }
+
+        const auto endTime = steady_clock::now();
+        /* time in seconds reflected as a double */
+        const auto timeDiff = duration_cast<duration<double>>(endTime - startTime).count();
+
+        uint64_t nodes = 0;
+        for (std::size_t i = 0; i < rootMoves.count() && depth > 0; i++) {
+            fmt::println("{}: {}", rootMoves[i], rootNodes[i]);
+        }
+
+        for (const auto count : rootNodes) {
+            nodes += count;
+        }
+
+        fmt::print("\n*** result ***\n"
+                   "nodes:       {}\n"
+                   "nps:         {:.0f}\n"
+                   "time:        {:.2f}ms\n",
+            nodes, nodes / timeDiff, timeDiff * 1000);
+
+        return nodes;
+    }
+
+    struct SuiteResult {
+        std::size_t positions;
+        std::size_t mismatches;
+        uint64_t nodes;
+        double seconds;
+
+        double nps() const
+        {
+            return nodes / seconds;
+        }
+    };
+
+    /* runs every position of a perft EPD file, eg: <fen> ;D1 20 ;D2 400 ;D3 8902
+     * positions are run in parallel as they are read, with a shared hash table - depths above maxDepth are skipped
+     * returns nullopt if the file couldn't be read */
+    static std::optional<SuiteResult> runSuite(const std::filesystem::path& path, uint8_t maxDepth = s_maxSuiteDepth, std::size_t threads = s_defaultThreads, std::size_t hashSizeMb = s_defaultHashSizeMb)
+    {
+        std::ifstream file(path);
+        if (!file) {
+            fmt::println("{} could not be opened", path.string());
+            return std::nullopt;
+        }
+
+        fmt::print("*** Starting perft suite - {}, max depth {}, threads {}, hash {}MB ***\n", path.string(), maxDepth, threads, hashSizeMb);
+
+        using namespace std::chrono;
+        const auto startTime = steady_clock::now();
+
+        std::size_t numPositions = 0;
+        std::size_t lineNumber = 0;
+        std::atomic<std::size_t> mismatches = 0;
+        std::atomic<uint64_t> nodes = 0;
+        std::atomic<std::size_t> pendingJobs = 0;
+
+        HashTable hashTable(hashSizeMb);
+        WorkStealingPool pool(threads);
+
+        /* positions are run as they are read - every depth is a job of its own and the deeper ones
+         * are split further so a single large position can't leave the other workers idle */
+        std::string line;
+        while (std::getline(file, line)) {
+            lineNumber++;
+
+            const std::string_view sv = trim(line);
+            if (sv.empty() || sv.starts_with('#')) {
+                continue;
+            }
+
+            const auto position = parseEpdLine(sv, maxDepth);
+            if (!position.has_value()) {
+                fmt::println("line {}: invalid perft entry: {}", lineNumber, sv);
+                mismatches++;
+                continue;
+            }
+
+            numPositions++;
+            for (const auto& entry : position->entries) {
+                pendingJobs++;
+                pool.submit([&pool, &hashTable, &mismatches, &nodes, &pendingJobs, lineNumber, board = position->board, entry] {
+                    const uint64_t result = entry.depth == 0 ? 1 : searchSplit(pool, board, entry.depth, hashTable, s_splitPlies);
+                    nodes += result;
+
+                    if (result != entry.expected) {
+                        fmt::println("line {}: mismatch at depth {} - expected {}, got {}", lineNumber, entry.depth, entry.expected, result);
+                        mismatches++;
+                    }
+
+                    pendingJobs--;
+                    pendingJobs.notify_all();
+                });
+            }
+        }
+
+        for (auto pending = pendingJobs.load(); pending > 0; pending = pendingJobs.load()) {
+            pendingJobs.wait(pending);
+        }
+
+        const auto endTime = steady_clock::now();
+        /* time in seconds reflected as a double */
+        const auto timeDiff = duration_cast<duration<double>>(endTime - startTime).count();
+
+        const SuiteResult result { numPositions, mismatches, nodes, timeDiff };
+
+        fmt::print("\n*** result ***\n"
+                   "positions:   {}\n"
+                   "mismatches:  {}\n"
+                   "nodes:       {}\n"
+                   "nps:         {:.0f}\n"
+                   "time:        {:.2f}ms\n",
+            result.positions, result.mismatches, result.nodes, result.nps(), result.seconds * 1000);
+
+        return result;
+    }
+
+    /* detailed perft - slower but counts captures, castles, checks etc. */
     constexpr static void run(const BitBoard& board, uint8_t depth)
     {
         reset();
@@ -42,23 +202,168 @@ public:
     }
 
 private:
+    /* plies below the root that are split into jobs - and the smallest subtree worth a job */
+    constexpr static inline uint8_t s_splitPlies { 1 };
+    constexpr static inline uint8_t s_minSplitDepth { 4 };
+
+    /* lockless entry - the key is stored xor'ed with the data so a torn write is detected as a miss
+     * data holds the node count in the upper 56 bits and the depth in the lower 8 bits */
+    struct HashEntry {
+        std::atomic<uint64_t> key;
+        std::atomic<uint64_t> data;
+    };
+
+    class HashTable {
+    public:
+        explicit HashTable(std::size_t sizeMb)
+            : m_size(std::max<std::size_t>((sizeMb * 1024 * 1024) / sizeof(HashEntry), 1))
+            , m_entries(std::make_unique<HashEntry[]>(m_size))
+        {
+        }
+
+        std::optional<uint64_t> probe(uint64_t hash, uint8_t depth) const
+        {
+            const auto& entry = m_entries[hash % m_size];
+            const uint64_t data = entry.data.load(std::memory_order_relaxed);
+            const uint64_t key = entry.key.load(std::memory_order_relaxed);
+
+            if ((key ^ data) != hash || (data & 0xff) != depth) {
+                return std::nullopt;
+            }
+
+            return data >> 8;
+        }
+
+        void write(uint64_t hash, uint8_t depth, uint64_t nodes)
+        {
+            auto& entry = m_entries[hash % m_size];
+            const uint64_t data = (nodes << 8) | depth;
+
+            entry.key.store(hash ^ data, std::memory_order_relaxed);
+            entry.data.store(data, std::memory_order_relaxed);
+        }
+
+    private:
+        std::size_t m_size;
+        std::unique_ptr<HashEntry[]> m_entries;
+    };
+
+    struct SuiteEntry {
+        uint8_t depth;
+        uint64_t expected;
+    };
+
+    struct SuitePosition {
+        BitBoard board;
+        std::vector<SuiteEntry> entries;
+    };
+
+    static std::string_view trim(std::string_view sv)
+    {
+        const auto first = sv.find_first_not_of(" \t\r");
+        if (first == std::string_view::npos) {
+            return {};
+        }
+
+        const auto last = sv.find_last_not_of(" \t\r");
+        return sv.substr(first, last - first + 1);
+    }
+
+    /* <fen> ;D<depth> <nodes> ;D<depth> <nodes> ... */
+    static std::optional<SuitePosition> parseEpdLine(std::string_view sv, uint8_t maxDepth)
+    {
+        auto separator = sv.find(';');
+        if (separator == std::string_view::npos) {
+            return std::nullopt;
+        }
+
+        const auto board = parsing::FenParser::parse(trim(sv.substr(0, separator)));
+        if (!board.has_value()) {
+            return std::nullopt;
+        }
+
+        SuitePosition position { *board, {} };
+
+        while (separator != std::string_view::npos) {
+            sv = sv.substr(separator + 1);
+            separator = sv.find(';');
+
+            const auto [depthSv, nodesSv] = parsing::split_sv_by_space(trim(sv.substr(0, separator)));
+            if (!depthSv.starts_with('D')) {
+                return std::nullopt;
+            }
+
+            const auto depth = parsing::to_number(depthSv.substr(1));
+            const auto nodes = parsing::to_number(trim(nodesSv));
+            if (!depth.has_value() || !nodes.has_value() || *depth < 0 || *nodes < 0) {
+                return std::nullopt;
+            }
+
+            if (*depth <= maxDepth) {
+                position.entries.emplace_back(*depth, *nodes);
+            }
+        }
+
+        return position;
+    }
+
+    /* subtrees are split into jobs for the first plies - waiting for them helps out on the pool */
+    static uint64_t searchSplit(WorkStealingPool& pool, const BitBoard& board, uint8_t depth, HashTable& hashTable, uint8_t splitPlies)
+    {
+        if (splitPlies == 0 || depth < s_minSplitDepth) {
+            return searchBulk(board, depth, hashTable);
+        }
+
+        movegen::ValidMoves moves;
+        core::getLegalMoves<movegen::MovePseudoLegal>(board, moves);
+
+        std::vector<WorkStealingPool::Future<uint64_t>> futures;
+        for (const auto move : moves) {
+            futures.push_back(pool.submit(searchSplit, std::ref(pool), core::performMove(board, move), depth - 1, std::ref(hashTable), splitPlies - 1));
+        }
+
+        uint64_t nodes = 0;
+        for (auto& future : futures) {
+            nodes += pool.get(future);
+        }
+
+        return nodes;
+    }
+
+    static uint64_t searchBulk(const BitBoard& board, uint8_t depth, HashTable& hashTable)
+    {
+        movegen::ValidMoves moves;
+        core::getLegalMoves<movegen::MovePseudoLegal>(board, moves);
+
+        /* bulk counting - the leaves are the legal moves of this position */
+        if (depth == 1) {
+            return moves.count();
+        }
+
+        if (const auto cached = hashTable.probe(board.hash, depth)) {
+            return *cached;
+        }
+
+        uint64_t nodes = 0;
+        for (const auto& move : moves) {
+            nodes += searchBulk(core::performMove(board, move), depth - 1, hashTable);
+        }
+
+        hashTable.write(board.hash, depth, nodes);
+        return nodes;
+    }
+
     constexpr static void search(const BitBoard& board, uint8_t depth, bool printMove = false)
     {
         movegen::ValidMoves moves;
-        core::getAllMoves<movegen::MovePseudoLegal>(board, moves);
-        uint64_t legalMoves = 0;
+        core::getLegalMoves<movegen::MovePseudoLegal>(board, moves);
 
         if (depth == 0) {
-            for (const auto& move : moves) {
-                auto newBoard = core::performMove(board, move);
-                if (core::isKingAttacked(newBoard, board.player)) {
-                    // invalid move
-                    continue;
-                }
-
-                legalMoves++;
+            /* the leaves are never made - checks are found from the current position */
+            const auto checkInfo = core::getCheckInfo(board);
 
-                if (core::isKingAttacked(newBoard)) {
+            for (const auto& move : moves) {
+                if (core::givesCheck(board, move, checkInfo)) {
                     s_checks++;
                 }
 
@@ -80,7 +385,7 @@ private:
                 s_nodes++;
             }
 
-            if (legalMoves == 0) {
+            if (moves.count() == 0) {
                 s_checkMates++;
             }
 
@@ -88,16 +393,7 @@ private:
         }
 
         for (const auto& move : moves) {
-            auto newBoard = core::performMove(board, move);
-
-            if (core::isKingAttacked(newBoard, board.player)) {
-                // invalid move
-                continue;
-            }
-
-            legalMoves++;
-
-            search(newBoard, depth - 1);
+            search(core::performMove(board, move), depth - 1);
 
             if (printMove) {
                 fmt::println("{}: {}", move, s_nodes - s_prevNodes);
@@ -105,7 +401,7 @@ private:
             }
         }
 
-        if (legalMoves == 0) {
+        if (moves.count() == 0) {
             s_checkMates++;
         }
     }
@@ -4,8 +4,32 @@
 #include <bit>
 #include <cstdint>
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 namespace utils {
 
+/* parallel bits extract - emitted through inline assembly when not compiling for BMI2
+ * so the instruction can be selected at runtime
+ * NOTE: the host must support BMI2 - see utils::s_cpuFeatures */
+[[nodiscard]] inline uint64_t pext(uint64_t source, uint64_t mask) noexcept
+{
+#if defined(__BMI2__)
+    return _pext_u64(source, mask);
+#elif defined(__x86_64__)
+    uint64_t result;
+    asm("pextq %[mask], %[source], %[result]"
+        : [result] "=r"(result)
+        : [source] "r"(source), [mask] "r"(mask));
+    return result;
+#else
+    (void)source;
+    (void)mask;
+    __builtin_unreachable();
+#endif
+}
+
 [[nodiscard]] constexpr uint64_t positionToSquare(BoardPosition pos) noexcept
 {
     return 1ULL << pos;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+/* runtime detection of the instruction sets the host supports
+ * a single binary can then pick the fastest slider lookup and nnue kernels at startup */
+
+namespace utils {
+
+struct CpuFeatures {
+    bool popcnt {};
+    bool bmi2 {};
+    bool fastPext {}; /* AMD zen 1 and 2 supports BMI2 but implements pext in (very slow) microcode */
+    bool avx2 {};
+    bool avx512 {}; /* AVX512F + AVX512BW */
+};
+
+inline CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features {};
+
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+
+    features.popcnt = __builtin_cpu_supports("popcnt");
+    features.bmi2 = __builtin_cpu_supports("bmi2");
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+
+    bool slowPext = false;
+    unsigned int eax {}, ebx {}, ecx {}, edx {};
+    if (__builtin_cpu_is("amd") && __get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        /* zen 3 and newer are family 0x19+ */
+        const unsigned int family = ((eax >> 8) & 0xf) + ((eax >> 20) & 0xff);
+        slowPext = family < 0x19;
+    }
+
+    features.fastPext = features.bmi2 && !slowPext;
+#endif
+
+    return features;
+}
+
+static inline const CpuFeatures s_cpuFeatures = detectCpuFeatures();
+
+/* the compiler is free to use any instruction set it has been told to target
+ * returns the first feature the binary was compiled for that the host doesn't support */
+inline std::optional<std::string_view> findMissingCpuFeature()
+{
+#ifdef __POPCNT__
+    if (!s_cpuFeatures.popcnt)
+        return "POPCNT";
+#endif
+#ifdef __BMI2__
+    if (!s_cpuFeatures.bmi2)
+        return "BMI2";
+#endif
+#ifdef __AVX2__
+    if (!s_cpuFeatures.avx2)
+        return "AVX2";
+#endif
+#ifdef __AVX512BW__
+    if (!s_cpuFeatures.avx512)
+        return "AVX512";
+#endif
+
+    return std::nullopt;
+}
+
+constexpr std::string_view popcountPath()
+{
+#ifdef __POPCNT__
+    return "POPCNT";
+#else
+    return "software";
+#endif
+}
+
+}
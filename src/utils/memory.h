@@ -1,6 +1,17 @@
 #pragma once
 
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 /* std::aligned_alloc and std::free are not available for windows
  * create helpers to make cross compilation easier */
@@ -25,4 +36,168 @@ constexpr void alignedFree(void* ptr)
 #endif
 }
 
+enum class PageType {
+    Default, /* regular 4KB pages */
+    Advised, /* transparent huge pages has been advised - not (yet) confirmed by the kernel */
+    Transparent, /* the kernel backs (part of) the allocation by transparent huge pages */
+    Huge, /* explicit 2MB huge pages reserved by the system */
+};
+
+constexpr std::string_view pageTypeToString(PageType pageType)
+{
+    switch (pageType) {
+    case PageType::Default:
+        return "default 4KB";
+    case PageType::Advised:
+        return "advised transparent 2MB";
+    case PageType::Transparent:
+        return "transparent 2MB";
+    case PageType::Huge:
+        return "explicit 2MB";
+    }
+
+    return "unknown";
+}
+
+/* the active mode of transparent huge pages, eg: "always", "madvise" or "never" - empty if unknown */
+inline std::string transparentHugePageMode()
+{
+#ifdef __linux__
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string line;
+    std::getline(file, line);
+
+    /* the active mode is the one in brackets: "always [madvise] never" */
+    const auto begin = line.find('[');
+    const auto end = line.find(']');
+    if (begin != std::string::npos && end != std::string::npos && begin < end) {
+        return line.substr(begin + 1, end - begin - 1);
+    }
+#endif
+
+    return {};
+}
+
+/* bytes of the mapping containing ptr that are backed by transparent huge pages
+ * as reported by the kernel in /proc/self/smaps - nullopt if it can't be read
+ * NOTE: memory is only backed once touched */
+inline std::optional<size_t> transparentHugePageBytes([[maybe_unused]] const void* ptr)
+{
+#ifdef __linux__
+    std::ifstream smaps("/proc/self/smaps");
+    if (!smaps) {
+        return std::nullopt;
+    }
+
+    const auto address = reinterpret_cast<uintptr_t>(ptr);
+    bool inMapping = false;
+
+    std::string line;
+    while (std::getline(smaps, line)) {
+        const std::string_view sv(line);
+        const std::string_view key = sv.substr(0, sv.find(' '));
+
+        /* mapping header: "start-end perms offset dev inode path" - followed by "Key: value kB" lines */
+        if (!key.ends_with(':')) {
+            const auto dash = key.find('-');
+            uintptr_t start {}, end {};
+            inMapping = dash != std::string_view::npos
+                && std::from_chars(key.data(), key.data() + dash, start, 16).ec == std::errc()
+                && std::from_chars(key.data() + dash + 1, key.data() + key.size(), end, 16).ec == std::errc()
+                && address >= start && address < end;
+            continue;
+        }
+
+        if (inMapping && key == "AnonHugePages:") {
+            const std::string_view value = sv.substr(sv.find_first_not_of(' ', key.size()));
+            size_t kb {};
+            if (std::from_chars(value.data(), value.data() + value.size(), kb).ec != std::errc()) {
+                return std::nullopt;
+            }
+
+            return kb * 1024;
+        }
+    }
+#endif
+
+    return std::nullopt;
+}
+
+struct LargePageAllocation {
+    void* ptr { nullptr };
+    size_t size {};
+    PageType pageType { PageType::Default };
+};
+
+/* large tables are probed randomly so every access is likely a TLB miss with regular pages
+ * try to back the allocation by huge pages - in order of preference:
+ *
+ * 1. explicit huge pages (requires pages reserved through vm.nr_hugepages)
+ * 2. transparent huge pages (madvise)
+ * 3. regular pages
+ *
+ * NOTE: huge pages are only supported on linux - other platforms use regular pages */
+inline LargePageAllocation largePageAlloc(size_t size, bool useLargePages)
+{
+    constexpr size_t hugePageSize = 2 * 1024 * 1024;
+    constexpr size_t defaultAlignment = 64;
+
+#ifdef __linux__
+    if (useLargePages) {
+        const size_t alignedSize = ((size + hugePageSize - 1) / hugePageSize) * hugePageSize;
+
+        void* ptr = mmap(nullptr, alignedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            return { .ptr = ptr, .size = alignedSize, .pageType = PageType::Huge };
+        }
+
+        ptr = alignedAlloc(hugePageSize, alignedSize);
+        if (ptr == nullptr) {
+            return {};
+        }
+
+        /* madvise succeeds even if transparent huge pages are disabled */
+        const bool advised = madvise(ptr, alignedSize, MADV_HUGEPAGE) == 0 && transparentHugePageMode() != "never";
+        return { .ptr = ptr, .size = alignedSize, .pageType = advised ? PageType::Advised : PageType::Default };
+    }
+#else
+    (void)useLargePages;
+    (void)hugePageSize;
+#endif
+
+    const size_t alignedSize = ((size + defaultAlignment - 1) / defaultAlignment) * defaultAlignment;
+    return { .ptr = alignedAlloc(defaultAlignment, alignedSize), .size = alignedSize, .pageType = PageType::Default };
+}
+
+/* confirms advised transparent huge pages once the memory has been touched - eg. by clearing it */
+inline PageType confirmedPageType(const LargePageAllocation& allocation)
+{
+    if (allocation.pageType != PageType::Advised) {
+        return allocation.pageType;
+    }
+
+    const auto hugeBytes = transparentHugePageBytes(allocation.ptr);
+    if (!hugeBytes.has_value()) {
+        return PageType::Advised;
+    }
+
+    return *hugeBytes > 0 ? PageType::Transparent : PageType::Default;
+}
+
+inline void largePageFree(const LargePageAllocation& allocation)
+{
+    if (allocation.ptr == nullptr) {
+        return;
+    }
+
+#ifdef __linux__
+    if (allocation.pageType == PageType::Huge) {
+        munmap(allocation.ptr, allocation.size);
+        return;
+    }
+#endif
+
+    alignedFree(allocation.ptr);
+}
+
 }
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* binding of search threads to cores or numa nodes
+ *
+ * memory is placed on the numa node of the thread that first touches it, so a searcher
+ * bound to one node and constructed by a thread on that same node has its history and
+ * correction tables in local memory
+ *
+ * NOTE: binding is only supported on linux - other platforms run unbound */
+
+namespace utils {
+
+enum class ThreadBinding {
+    None, /* the OS schedules threads freely */
+    Cores, /* every searcher is bound to its own core */
+    Numa, /* searchers are spread evenly across numa nodes and bound to all cores of their node */
+};
+
+constexpr std::string_view threadBindingToString(ThreadBinding binding)
+{
+    switch (binding) {
+    case ThreadBinding::None:
+        return "none";
+    case ThreadBinding::Cores:
+        return "cores";
+    case ThreadBinding::Numa:
+        return "numa";
+    }
+
+    return "unknown";
+}
+
+constexpr std::optional<ThreadBinding> threadBindingFromString(std::string_view str)
+{
+    for (const auto binding : { ThreadBinding::None, ThreadBinding::Cores, ThreadBinding::Numa }) {
+        if (threadBindingToString(binding) == str) {
+            return binding;
+        }
+    }
+
+    return std::nullopt;
+}
+
+using CpuList = std::vector<int>;
+
+/* parses the linux cpu list format, eg: "0-3,8,10-11" */
+inline CpuList parseCpuList(std::string_view str)
+{
+    CpuList cpus;
+
+    while (!str.empty()) {
+        const auto sep = str.find(',');
+        const auto range = str.substr(0, sep);
+        str = sep == std::string_view::npos ? "" : str.substr(sep + 1);
+
+        const auto dash = range.find('-');
+        const auto firstStr = range.substr(0, dash);
+        const auto lastStr = dash == std::string_view::npos ? firstStr : range.substr(dash + 1);
+
+        int first {}, last {};
+        if (std::from_chars(firstStr.data(), firstStr.data() + firstStr.size(), first).ec != std::errc()
+            || std::from_chars(lastStr.data(), lastStr.data() + lastStr.size(), last).ec != std::errc()) {
+            continue;
+        }
+
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    return cpus;
+}
+
+class CpuTopology {
+public:
+    /* the cpus the process is allowed to run on
+     * NOTE: read at startup - before any thread has been bound */
+    static const CpuList& allowedCpus()
+    {
+        return s_allowedCpus;
+    }
+
+    /* allowed cpus grouped by numa node - a single node if the topology isn't available */
+    static const std::vector<CpuList>& numaNodes()
+    {
+        return s_numaNodes;
+    }
+
+    /* the cpus a searcher should be bound to - empty if it should run unbound */
+    static CpuList cpusForSearcher(ThreadBinding binding, std::size_t index, std::size_t numSearchers)
+    {
+        if (s_allowedCpus.empty()) {
+            return {};
+        }
+
+        switch (binding) {
+        case ThreadBinding::None:
+            return s_allowedCpus;
+        case ThreadBinding::Cores:
+            return { s_allowedCpus[index % s_allowedCpus.size()] };
+        case ThreadBinding::Numa: {
+            /* consecutive searchers share a node so the primary and its neighbours stay close */
+            const std::size_t node = index * s_numaNodes.size() / std::max<std::size_t>(numSearchers, 1);
+            return s_numaNodes[std::min(node, s_numaNodes.size() - 1)];
+        }
+        }
+
+        return {};
+    }
+
+    /* binds the calling thread - returns false if the binding failed or isn't supported */
+    static bool bindCurrentThread(const CpuList& cpus)
+    {
+#ifdef __linux__
+        if (cpus.empty()) {
+            return false;
+        }
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (const int cpu : cpus) {
+            CPU_SET(cpu, &set);
+        }
+
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        (void)cpus;
+        return false;
+#endif
+    }
+
+    /* the cpus the calling thread is currently allowed to run on - empty if not supported */
+    static CpuList currentThreadCpus()
+    {
+        CpuList cpus;
+
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+
+        return cpus;
+    }
+
+private:
+    static CpuList readAllowedCpus()
+    {
+        CpuList cpus;
+
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#endif
+
+        return cpus;
+    }
+
+    static std::vector<CpuList> readNumaNodes(const CpuList& allowedCpus)
+    {
+        std::vector<CpuList> nodes;
+
+#ifdef __linux__
+        std::error_code ec;
+        for (int node = 0;; node++) {
+            const auto path = std::filesystem::path("/sys/devices/system/node") / ("node" + std::to_string(node)) / "cpulist";
+            if (!std::filesystem::exists(path, ec)) {
+                break;
+            }
+
+            std::ifstream file(path);
+            std::string line;
+            std::getline(file, line);
+
+            /* only keep the cpus we're allowed to run on - nodes without any are skipped */
+            CpuList cpus;
+            for (const int cpu : parseCpuList(line)) {
+                if (std::ranges::find(allowedCpus, cpu) != allowedCpus.end()) {
+                    cpus.push_back(cpu);
+                }
+            }
+
+            if (!cpus.empty()) {
+                nodes.push_back(std::move(cpus));
+            }
+        }
+#endif
+
+        if (nodes.empty() && !allowedCpus.empty()) {
+            nodes.push_back(allowedCpus);
+        }
+
+        return nodes;
+    }
+
+    static inline const CpuList s_allowedCpus = readAllowedCpus();
+    static inline const std::vector<CpuList> s_numaNodes = readNumaNodes(s_allowedCpus);
+};
+
+/* restores the affinity of the calling thread once out of scope
+ * threads created later - or later jobs of a pool thread - inherit the binding otherwise
+ * a disabled scope doesn't touch the affinity at all, eg. when threads aren't bound */
+class ScopedThreadAffinity {
+public:
+    explicit ScopedThreadAffinity(bool enabled = true)
+        : m_cpus(enabled ? CpuTopology::currentThreadCpus() : CpuList {})
+    {
+    }
+
+    ~ScopedThreadAffinity()
+    {
+        if (!m_cpus.empty()) {
+            CpuTopology::bindCurrentThread(m_cpus);
+        }
+    }
+
+    ScopedThreadAffinity(const ScopedThreadAffinity&) = delete;
+    ScopedThreadAffinity& operator=(const ScopedThreadAffinity&) = delete;
+
+private:
+    CpuList m_cpus;
+};
+
+}
@@ -0,0 +1,95 @@
+#include "parsing/fen_parser.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#define private public
+#include "evaluation/evaluator.h"
+
+using namespace evaluation;
+
+namespace {
+
+struct SearchResult {
+    movegen::Move bestMove;
+    uint64_t nodes;
+
+    bool operator==(const SearchResult&) const = default;
+};
+
+/* not every searcher table is cleared by a reset - use a fresh evaluator so every run starts from the same state */
+std::vector<SearchResult> runSearches(const BitBoard& board, std::size_t threads)
+{
+    Evaluator evaluator;
+    evaluator.setDeterministic(true);
+    evaluator.resizeSearchers(threads);
+    evaluator.clearHashTable();
+
+    std::vector<SearchResult> results;
+
+    /* a depth limited search and a search with a node budget - repeated so the tables carry over */
+    for (int i = 0; i < 2; i++) {
+        evaluator.reset();
+        results.push_back({ evaluator.getBestMove(board, 7), evaluator.getNodes() });
+
+        evaluator.reset();
+        TimeManager::setNodeLimit(5000);
+        results.push_back({ evaluator.getBestMove(board), evaluator.getNodes() });
+    }
+
+    return results;
+}
+
+}
+
+TEST_CASE("Deterministic Search", "[DeterministicSearch]")
+{
+    core::TranspositionTable::setSizeMb(16);
+    interface::setSearchInfoEnabled(false);
+
+    const auto board = parsing::FenParser::parse("r3k2r/2pb1ppp/2pp1q2/p7/1nP1B3/1P2P3/P2N1PPP/R2QK2R w KQkq a6 0 14");
+    REQUIRE(board.has_value());
+
+    SECTION("Test repeated searches are identical")
+    {
+        for (const std::size_t threads : { 1, 2, 4 }) {
+            const auto results = runSearches(*board, threads);
+
+            for (int i = 0; i < 3; i++) {
+                REQUIRE(runSearches(*board, threads) == results);
+            }
+        }
+    }
+
+    Evaluator evaluator;
+    evaluator.setDeterministic(true);
+
+    SECTION("Test node budget is per searcher")
+    {
+        const uint64_t budget = 5000;
+        evaluator.resizeSearchers(3);
+
+        evaluator.reset();
+        TimeManager::setNodeLimit(budget);
+        std::ignore = evaluator.getBestMove(*board);
+
+        for (const auto& stats : evaluator.getSearcherStats()) {
+            /* the budget is checked between moves - allow a small overshoot */
+            REQUIRE(stats.nodes >= budget);
+            REQUIRE(stats.nodes < budget + 100);
+        }
+    }
+
+    SECTION("Test the overlays are disabled again")
+    {
+        evaluator.resizeSearchers(2);
+        evaluator.setDeterministic(false);
+
+        for (const auto& searcher : evaluator.m_searchers) {
+            REQUIRE_FALSE(searcher->isDeterministic());
+            REQUIRE_FALSE(searcher->isOutOfNodes());
+        }
+    }
+
+    TimeManager::reset();
+    interface::setSearchInfoEnabled(true);
+}
@@ -0,0 +1,55 @@
+#include "evaluation/eval_cache.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+
+using namespace evaluation;
+
+TEST_CASE("EvalCache: Write and probe", "[EvalCache]")
+{
+    /* too large for the stack */
+    auto cache = std::make_unique<EvalCache>();
+
+    constexpr uint64_t key = 0x123456789abcdef0ULL;
+
+    REQUIRE_FALSE(cache->probe(key).has_value());
+
+    cache->write(key, 123);
+    REQUIRE(cache->probe(key) == 123);
+
+    /* negative scores must survive the packing */
+    cache->write(key, -456);
+    REQUIRE(cache->probe(key) == -456);
+}
+
+TEST_CASE("EvalCache: Colliding keys", "[EvalCache]")
+{
+    auto cache = std::make_unique<EvalCache>();
+
+    /* same index but different upper bits */
+    constexpr uint64_t key1 = 0x1111111111110042ULL;
+    constexpr uint64_t key2 = 0x2222222222220042ULL;
+
+    cache->write(key1, 10);
+    REQUIRE(cache->probe(key1) == 10);
+    REQUIRE_FALSE(cache->probe(key2).has_value());
+
+    /* newest entry always replaces */
+    cache->write(key2, -20);
+    REQUIRE(cache->probe(key2) == -20);
+    REQUIRE_FALSE(cache->probe(key1).has_value());
+}
+
+TEST_CASE("EvalCache: Clear", "[EvalCache]")
+{
+    auto cache = std::make_unique<EvalCache>();
+
+    constexpr uint64_t key = 0xdeadbeefcafe0001ULL;
+
+    cache->write(key, 0);
+    REQUIRE(cache->probe(key) == 0);
+
+    cache->clear();
+    REQUIRE_FALSE(cache->probe(key).has_value());
+}
@@ -11,6 +11,7 @@ using namespace movegen;
 constexpr inline void setPieceAtSquare(BitBoard& board, Piece type, BoardPosition pos)
 {
     board.pieces[type] |= utils::positionToSquare(pos);
+    board.pieceOn[pos] = type;
 }
 
 TEST_CASE("HistoryMoves: Updating quiet moves", "[HistoryMoves]")
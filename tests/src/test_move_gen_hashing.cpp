@@ -6,10 +6,31 @@
 
 constexpr uint8_t s_defaultSearchDepth = 3;
 
+/* the mailbox must mirror the piece bitboards on every square */
+bool isMailboxInSync(const BitBoard& board)
+{
+    for (uint8_t i = 0; i < s_amountSquares; i++) {
+        const auto pos = static_cast<BoardPosition>(i);
+        const uint64_t square = utils::positionToSquare(pos);
+
+        auto piece = board.getAttackerAtSquare<PlayerWhite>(square);
+        if (!piece.has_value())
+            piece = board.getAttackerAtSquare<PlayerBlack>(square);
+
+        if (board.getPieceAt(pos) != piece)
+            return false;
+    }
+
+    return true;
+}
+
 void testAllMoves(const BitBoard& board, uint8_t depth = s_defaultSearchDepth)
 {
     REQUIRE(board.hash == core::generateHash(board));
     REQUIRE(board.kpHash == core::generateKingPawnHash(board));
+    REQUIRE(isMailboxInSync(board));
+
+    const auto checkInfo = core::getCheckInfo(board);
 
     movegen::ValidMoves moves;
     core::getAllMoves<movegen::MovePseudoLegal>(board, moves);
@@ -23,6 +44,15 @@ void testAllMoves(const BitBoard& board, uint8_t depth = s_defaultSearchDepth)
 
         REQUIRE(newBoard.hash == core::generateHash(newBoard));
         REQUIRE(newBoard.kpHash == core::generateKingPawnHash(newBoard));
+        REQUIRE(isMailboxInSync(newBoard));
+
+        /* incrementally updated checkers and the check test made before the move */
+        REQUIRE(newBoard.checkers == core::computeCheckers(newBoard));
+        REQUIRE(core::givesCheck(board, move, checkInfo) == (newBoard.checkers != 0));
+
+        /* incrementally updated evaluation accumulators */
+        REQUIRE(newBoard.psqtScore.value == evaluation::computePsqtScore(newBoard).value);
+        REQUIRE(newBoard.phase == evaluation::computePhase(newBoard));
 
         if (depth != 0) {
             testAllMoves(newBoard, depth - 1);
@@ -58,4 +88,20 @@ TEST_CASE("Movegen Hashing", "[movegen]")
 
         testAllMoves(board.value());
     }
+
+    SECTION("Test from discovered check positions")
+    {
+        /* en pessant along the rank of the king */
+        const auto enPessantBoard = parsing::FenParser::parse("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 0");
+        REQUIRE(enPessantBoard.has_value());
+
+        testAllMoves(enPessantBoard.value());
+
+        /* castling with check from the rook */
+        const auto castleBoard = parsing::FenParser::parse("5k2/8/8/8/8/8/8/R3K2R w KQ - 0 1");
+        REQUIRE(castleBoard.has_value());
+        REQUIRE(core::givesCheck(*castleBoard, movegen::Move::createCastle(E1, G1, CastleWhiteKingSide)));
+
+        testAllMoves(castleBoard.value());
+    }
 }
@@ -0,0 +1,189 @@
+#include "core/move_handling.h"
+#include "parsing/fen_parser.h"
+#include "search/move_picker.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace search;
+
+namespace {
+
+constexpr std::array<std::string_view, 5> s_positions = {
+    s_startPosFen,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 0",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 0",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+bool contains(const movegen::ValidMoves& moves, movegen::Move move)
+{
+    return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
+
+template<movegen::MoveType type>
+void verifyPseudoLegal(const BitBoard& board, const std::vector<movegen::Move>& candidates)
+{
+    movegen::ValidMoves moves;
+    core::getAllMoves<type>(board, moves);
+
+    for (const auto move : candidates) {
+        INFO("move: " << move.getData() << " type: " << type);
+        REQUIRE(core::isPseudoLegal<type>(board, move) == contains(moves, move));
+    }
+}
+
+/* every node is tested with its own moves, the moves of the previous node and random moves */
+void walk(const BitBoard& board, uint8_t depth, std::vector<movegen::Move>& previousMoves, std::mt19937& rng)
+{
+    movegen::ValidMoves moves;
+    core::getAllMoves<movegen::MovePseudoLegal>(board, moves);
+
+    std::vector<movegen::Move> candidates(moves.begin(), moves.end());
+    candidates.insert(candidates.end(), previousMoves.begin(), previousMoves.end());
+    for (int i = 0; i < 32; i++) {
+        candidates.push_back(std::bit_cast<movegen::Move>(static_cast<uint16_t>(rng())));
+    }
+
+    verifyPseudoLegal<movegen::MovePseudoLegal>(board, candidates);
+    verifyPseudoLegal<movegen::MoveCapture>(board, candidates);
+    verifyPseudoLegal<movegen::MoveNoisy>(board, candidates);
+    verifyPseudoLegal<movegen::MoveQuiet>(board, candidates);
+
+    /* the staged generation must produce the same moves as the full generation */
+    movegen::ValidMoves noisy, quiets;
+    core::getAllMoves<movegen::MoveNoisy>(board, noisy);
+    core::getAllMoves<movegen::MoveQuiet>(board, quiets);
+
+    REQUIRE(noisy.count() + quiets.count() == moves.count());
+    for (const auto move : moves) {
+        REQUIRE(contains(move.isNoisyMove() ? noisy : quiets, move));
+    }
+
+    /* legal moves must match performing the move and testing if our king is attacked */
+    movegen::ValidMoves legalMoves;
+    core::getLegalMoves<movegen::MovePseudoLegal>(board, legalMoves);
+
+    uint32_t expectedLegalMoves = 0;
+    for (const auto move : moves) {
+        const bool isLegal = !core::isKingAttacked(core::performMove(board, move), board.player);
+        expectedLegalMoves += isLegal;
+
+        REQUIRE(contains(legalMoves, move) == isLegal);
+    }
+    REQUIRE(legalMoves.count() == expectedLegalMoves);
+
+    /* the picker returns the legal moves only */
+    static SearchTables searchTables {};
+    MovePicker<movegen::MovePseudoLegal> picker { searchTables, 0, PickerPhase::TtMove, candidates.back() };
+
+    uint32_t pickedMoves = 0;
+    while (const auto move = picker.pickNextMove(board)) {
+        REQUIRE(contains(legalMoves, *move));
+        pickedMoves++;
+    }
+    REQUIRE(pickedMoves == legalMoves.count());
+
+    previousMoves.assign(moves.begin(), moves.end());
+
+    if (depth == 0)
+        return;
+
+    for (const auto move : moves) {
+        const auto newBoard = core::performMove(board, move);
+        if (core::isKingAttacked(newBoard, board.player))
+            continue;
+
+        walk(newBoard, depth - 1, previousMoves, rng);
+    }
+}
+
+}
+
+TEST_CASE("MovePicker: pseudo legality and legality match move generation", "[MovePicker]")
+{
+    std::mt19937 rng(1234);
+
+    for (const auto fen : s_positions) {
+        const auto board = parsing::FenParser::parse(fen);
+        REQUIRE(board.has_value());
+
+        std::vector<movegen::Move> previousMoves;
+        walk(*board, 2, previousMoves, rng);
+    }
+}
+
+TEST_CASE("MovePicker: tt move is picked first and only once", "[MovePicker]")
+{
+    SearchTables searchTables {};
+
+    for (const auto fen : s_positions) {
+        const auto board = parsing::FenParser::parse(fen);
+        REQUIRE(board.has_value());
+
+        movegen::ValidMoves moves;
+        core::getLegalMoves<movegen::MovePseudoLegal>(*board, moves);
+
+        for (const auto ttMove : moves) {
+            MovePicker<movegen::MovePseudoLegal> picker { searchTables, 0, PickerPhase::TtMove, ttMove };
+
+            std::vector<movegen::Move> picked;
+            while (const auto move = picker.pickNextMove(*board)) {
+                picked.push_back(*move);
+            }
+
+            REQUIRE(picked.size() == moves.count());
+            REQUIRE(picked.front() == ttMove);
+            REQUIRE(std::count(picked.begin(), picked.end(), ttMove) == 1);
+        }
+
+        /* a tt move from another position is never picked */
+        const auto foreignMove = movegen::Move::create(A3, H5, false);
+        MovePicker<movegen::MovePseudoLegal> picker { searchTables, 0, PickerPhase::TtMove, foreignMove };
+
+        uint32_t count = 0;
+        while (const auto move = picker.pickNextMove(*board)) {
+            REQUIRE(*move != foreignMove);
+            count++;
+        }
+
+        REQUIRE(count == moves.count());
+    }
+}
+
+TEST_CASE("MovePicker: killers are picked before the other quiets", "[MovePicker]")
+{
+    SearchTables searchTables {};
+
+    const auto board = parsing::FenParser::parse("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 0");
+    REQUIRE(board.has_value());
+
+    const auto killer = movegen::Move::createCastle(E1, G1, CastleWhiteKingSide);
+    const auto illegalKiller = movegen::Move::create(A2, A4, false); /* not a double push */
+    searchTables.updateKillerMoves(illegalKiller, 0);
+    searchTables.updateKillerMoves(killer, 0);
+
+    MovePicker<movegen::MovePseudoLegal> picker { searchTables, 0, PickerPhase::TtMove };
+
+    std::vector<movegen::Move> picked;
+    while (const auto move = picker.pickNextMove(*board)) {
+        picked.push_back(*move);
+    }
+
+    movegen::ValidMoves moves;
+    core::getLegalMoves<movegen::MovePseudoLegal>(*board, moves);
+    REQUIRE(picked.size() == moves.count());
+
+    const auto firstQuiet = std::ranges::find_if(picked, [](const auto move) { return move.isQuietMove(); });
+    REQUIRE(firstQuiet != picked.end());
+    REQUIRE(*firstQuiet == killer);
+    REQUIRE(std::ranges::count(picked, killer) == 1);
+    REQUIRE(std::ranges::count(picked, illegalKiller) == 0);
+}
@@ -0,0 +1,179 @@
+#include "core/move_handling.h"
+#include "nnue/nnue.h"
+#include "parsing/fen_parser.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace nnue;
+
+namespace {
+
+/* random network with weights in the ranges a trained network would have */
+void loadRandomNetwork()
+{
+    auto network = std::make_unique<Network>();
+    std::mt19937 rng(1234);
+
+    std::uniform_int_distribution<int16_t> featureDist(-40, 40);
+    std::uniform_int_distribution<int16_t> outputDist(-126, 126);
+
+    for (auto& row : network->featureWeights) {
+        for (auto& weight : row) {
+            weight = featureDist(rng);
+        }
+    }
+
+    for (auto& bias : network->featureBias) {
+        bias = featureDist(rng);
+    }
+
+    for (auto& weight : network->outputWeights) {
+        weight = outputDist(rng);
+    }
+
+    network->outputBias = outputDist(rng);
+
+    std::vector<unsigned char> data(s_networkBytes);
+    std::memcpy(data.data(), network.get(), s_networkBytes);
+
+    REQUIRE(Nnue::load(data.data(), data.size()));
+}
+
+void testAllMoves(const BitBoard& board, const Accumulator& accumulator, uint8_t depth)
+{
+    auto refreshed = std::make_unique<Accumulator>();
+    refreshed->refresh(Nnue::getNetwork(), board);
+    REQUIRE(refreshed->values == accumulator.values);
+
+    movegen::ValidMoves moves;
+    core::getAllMoves<movegen::MovePseudoLegal>(board, moves);
+    for (const auto& move : moves) {
+        const auto newBoard = core::performMove(board, move);
+
+        if (core::isKingAttacked(newBoard, board.player)) {
+            continue;
+        }
+
+        auto updated = std::make_unique<Accumulator>();
+        updated->update(Nnue::getNetwork(), accumulator, board, newBoard);
+
+        if (depth != 0) {
+            testAllMoves(newBoard, *updated, depth - 1);
+        } else {
+            refreshed->refresh(Nnue::getNetwork(), newBoard);
+            REQUIRE(refreshed->values == updated->values);
+        }
+    }
+}
+
+Score evaluateFen(std::string_view fen)
+{
+    const auto board = parsing::FenParser::parse(fen);
+    REQUIRE(board.has_value());
+
+    auto accumulator = std::make_unique<Accumulator>();
+    accumulator->refresh(Nnue::getNetwork(), *board);
+
+    return Nnue::evaluate(*accumulator, board->player);
+}
+
+}
+
+TEST_CASE("Nnue: Incremental accumulator", "[nnue]")
+{
+    loadRandomNetwork();
+
+    const auto testPosition = [](std::string_view fen, uint8_t depth) {
+        const auto board = parsing::FenParser::parse(fen);
+        REQUIRE(board.has_value());
+
+        auto accumulator = std::make_unique<Accumulator>();
+        accumulator->refresh(Nnue::getNetwork(), *board);
+
+        testAllMoves(*board, *accumulator, depth);
+    };
+
+    SECTION("Start position")
+    {
+        testPosition(s_startPosFen, 2);
+    }
+
+    SECTION("Castling and en passant")
+    {
+        testPosition("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 0", 1);
+    }
+
+    SECTION("Promotions")
+    {
+        testPosition("3k2n1/PP4PP/2P2P2/8/8/1p6/p6p/1N1K4 w - - 0 0", 2);
+    }
+}
+
+TEST_CASE("Nnue: Perspective symmetry", "[nnue]")
+{
+    loadRandomNetwork();
+
+    /* the same position with colors swapped and the board mirrored must evaluate the same for the player to move */
+    REQUIRE(evaluateFen("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 0")
+        == evaluateFen("r3k2r/pppbbppp/2n2q1P/1P2p3/3pn3/BN2PNP1/P1PPQPB1/R3K2R b KQkq - 0 0"));
+
+    REQUIRE(evaluateFen("3k2n1/PP4PP/2P2P2/8/8/1p6/p6p/1N1K4 w - - 0 0")
+        == evaluateFen("1n1k4/P6P/1P6/8/8/2p2p2/pp4pp/3K2N1 b - - 0 0"));
+}
+
+TEST_CASE("Nnue: SIMD kernels", "[nnue]")
+{
+    constexpr std::size_t size = 64;
+
+    alignas(64) std::array<int16_t, size> input;
+    alignas(64) std::array<int16_t, size> add;
+    alignas(64) std::array<int16_t, size> sub;
+    alignas(64) std::array<int16_t, size> weights;
+    alignas(64) std::array<int16_t, size> output;
+
+    for (std::size_t i = 0; i < size; i++) {
+        input[i] = static_cast<int16_t>(i * 7) - 150;
+        add[i] = static_cast<int16_t>(i) - 32;
+        sub[i] = static_cast<int16_t>(i % 5);
+        weights[i] = static_cast<int16_t>(i * 3) - 90;
+    }
+
+    const std::array<const int16_t*, 1> adds { add.data() };
+    const std::array<const int16_t*, 1> subs { sub.data() };
+
+    int32_t expectedDot = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        const int32_t clipped = std::clamp<int32_t>(input[i], 0, s_qa);
+        expectedDot += clipped * clipped * weights[i];
+    }
+
+    /* test every path the host supports */
+    const auto defaultPath = simd::s_simdPath;
+    for (const auto path : { simd::SimdPath::Scalar, simd::SimdPath::Avx2, simd::SimdPath::Avx512 }) {
+        if (path > defaultPath) {
+            continue;
+        }
+
+        simd::s_simdPath = path;
+        output.fill(0);
+
+        simd::addSub<size>(output.data(), input.data(), adds, subs);
+        for (std::size_t i = 0; i < size; i++) {
+            REQUIRE(output[i] == input[i] + add[i] - sub[i]);
+        }
+
+        REQUIRE(simd::screluDot<size>(input.data(), weights.data(), s_qa) == expectedDot);
+    }
+
+    simd::s_simdPath = defaultPath;
+}
+
+TEST_CASE("Nnue: Invalid network size", "[nnue]")
+{
+    std::vector<unsigned char> data(s_networkBytes - 1);
+    REQUIRE_FALSE(Nnue::load(data.data(), data.size()));
+}
@@ -42,3 +42,27 @@ TEST_CASE("Perft", "[perft]")
         REQUIRE(Perft::s_checkMates == 1);
     }
 }
+
+TEST_CASE("Parallel perft", "[perft]")
+{
+    SECTION("Test parallel perft from start position")
+    {
+        const auto board = parsing::FenParser::parse(s_startPosFen);
+        REQUIRE(board.has_value());
+
+        REQUIRE(Perft::runParallel(board.value(), 0, 4) == 1);
+        REQUIRE(Perft::runParallel(board.value(), 1, 4) == 20);
+        REQUIRE(Perft::runParallel(board.value(), 5, 4) == 4865609);
+    }
+
+    SECTION("Test parallel perft from tricky position (Kiwipete)")
+    {
+        const auto fenBoard = parsing::FenParser::parse("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 0");
+        REQUIRE(fenBoard.has_value());
+
+        REQUIRE(Perft::runParallel(fenBoard.value(), 4, 4) == 4085603);
+
+        /* tiny table to force collisions between positions and depths */
+        REQUIRE(Perft::runParallel(fenBoard.value(), 4, 4, 1) == 4085603);
+    }
+}
@@ -0,0 +1,52 @@
+#include <catch2/catch_test_macros.hpp>
+
+#define private public
+#include <tools/perft.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace tools;
+
+/* path is set by meson - the suite is located in tests/data */
+#ifndef PERFT_SUITE_PATH
+#define PERFT_SUITE_PATH "tests/data/perft_suite.epd"
+#endif
+
+TEST_CASE("Perft suite", "[perft]")
+{
+    SECTION("Test all positions of the perft suite")
+    {
+        /* keep the depth low enough to run the full suite in a debug build */
+        const auto result = Perft::runSuite(PERFT_SUITE_PATH, 4, 4);
+        REQUIRE(result.has_value());
+        REQUIRE(result->positions == 21);
+        REQUIRE(result->mismatches == 0);
+    }
+
+    SECTION("Test mismatches and invalid entries are reported")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "meltdown_test_perft_suite.epd";
+        {
+            std::ofstream file(path);
+            file << "# comment\n"
+                 << "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 ;D1 20 ;D2 401 ;D3 8902\n"
+                 << "\n"
+                 << "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - ;D1 14 ;D2 191\n"
+                 << "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - ;D1 fourteen\n";
+        }
+
+        const auto result = Perft::runSuite(path, 3, 2);
+        std::filesystem::remove(path);
+
+        REQUIRE(result.has_value());
+        REQUIRE(result->positions == 2);
+        REQUIRE(result->mismatches == 2);
+        REQUIRE(result->nodes == 20 + 400 + 8902 + 14 + 191);
+    }
+
+    SECTION("Test missing file")
+    {
+        REQUIRE_FALSE(Perft::runSuite("does/not/exist.epd").has_value());
+    }
+}
@@ -58,7 +58,7 @@ TEST_CASE("Scoring", "[scoring]")
 
             movegen::ValidMoves results {};
             SearchTables searchTables {};
-            MovePicker<movegen::MoveCapture> picker { searchTables, 0, PickerPhase::GenerateMoves };
+            MovePicker<movegen::MoveCapture> picker { searchTables, 0, PickerPhase::TtMove };
 
             while (const auto moveOpt = picker.pickNextMove(*board)) {
                 results.addMove(moveOpt.value());
@@ -80,7 +80,7 @@ TEST_CASE("Scoring", "[scoring]")
 
             movegen::ValidMoves results {};
             SearchTables searchTables {};
-            MovePicker<movegen::MovePseudoLegal> picker { searchTables, 0, PickerPhase::GenerateMoves };
+            MovePicker<movegen::MovePseudoLegal> picker { searchTables, 0, PickerPhase::TtMove };
 
             while (const auto moveOpt = picker.pickNextMove(*board)) {
                 results.addMove(moveOpt.value());
@@ -0,0 +1,46 @@
+#include "movegen/bishops.h"
+#include "movegen/rooks.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+
+using namespace movegen;
+
+TEST_CASE("Sliders: Magic hashing", "[sliders]")
+{
+    std::mt19937_64 rng(4321);
+
+    for (uint8_t square = 0; square < s_amountSquares; square++) {
+        const auto pos = static_cast<BoardPosition>(square);
+
+        for (int i = 0; i < 1000; i++) {
+            /* sparse and dense occupancies */
+            const uint64_t occupancy = i % 2 ? rng() : rng() & rng() & rng();
+
+            REQUIRE(getRookMovesMagic(pos, occupancy) == rookAttacksWithBlock(square, occupancy));
+            REQUIRE(getBishopMovesMagic(pos, occupancy) == bishopAttacksWithBlock(square, occupancy));
+        }
+    }
+}
+
+TEST_CASE("Sliders: PEXT", "[sliders]")
+{
+    /* can't execute pext on this host */
+    if (!utils::s_cpuFeatures.bmi2) {
+        return;
+    }
+
+    std::mt19937_64 rng(4321);
+
+    for (uint8_t square = 0; square < s_amountSquares; square++) {
+        const auto pos = static_cast<BoardPosition>(square);
+
+        for (int i = 0; i < 1000; i++) {
+            const uint64_t occupancy = i % 2 ? rng() : rng() & rng() & rng();
+
+            REQUIRE(getRookMovesPext(pos, occupancy) == rookAttacksWithBlock(square, occupancy));
+            REQUIRE(getBishopMovesPext(pos, occupancy) == bishopAttacksWithBlock(square, occupancy));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+#include <catch2/catch_test_macros.hpp>
+
+#define private public
+#include "evaluation/evaluator.h"
+#include "parsing/fen_parser.h"
+#include "utils/thread_affinity.h"
+
+using namespace utils;
+
+TEST_CASE("Test Thread Affinity", "[ThreadAffinity]")
+{
+    SECTION("Test binding strings")
+    {
+        REQUIRE(threadBindingFromString("none") == ThreadBinding::None);
+        REQUIRE(threadBindingFromString("cores") == ThreadBinding::Cores);
+        REQUIRE(threadBindingFromString("numa") == ThreadBinding::Numa);
+        REQUIRE_FALSE(threadBindingFromString("all").has_value());
+    }
+
+    SECTION("Test cpu list parsing")
+    {
+        REQUIRE(parseCpuList("0") == CpuList { 0 });
+        REQUIRE(parseCpuList("0-3,8,10-11") == CpuList { 0, 1, 2, 3, 8, 10, 11 });
+        REQUIRE(parseCpuList("").empty());
+        REQUIRE(parseCpuList("a-b,2") == CpuList { 2 });
+    }
+
+    SECTION("Test topology")
+    {
+        /* every allowed cpu belongs to exactly one node */
+        std::size_t nodeCpus = 0;
+        for (const auto& node : CpuTopology::numaNodes()) {
+            REQUIRE_FALSE(node.empty());
+            nodeCpus += node.size();
+        }
+
+        REQUIRE(nodeCpus == CpuTopology::allowedCpus().size());
+    }
+
+    SECTION("Test searcher cpus")
+    {
+        const auto& allowed = CpuTopology::allowedCpus();
+        const auto& nodes = CpuTopology::numaNodes();
+
+        if (allowed.empty()) {
+            return;
+        }
+
+        REQUIRE(CpuTopology::cpusForSearcher(ThreadBinding::None, 3, 4) == allowed);
+
+        for (std::size_t i = 0; i < 2 * allowed.size(); i++) {
+            REQUIRE(CpuTopology::cpusForSearcher(ThreadBinding::Cores, i, 2 * allowed.size()) == CpuList { allowed[i % allowed.size()] });
+        }
+
+        /* searchers are spread in blocks - the first on the first node and the last on the last */
+        const std::size_t numSearchers = 8;
+        REQUIRE(CpuTopology::cpusForSearcher(ThreadBinding::Numa, 0, numSearchers) == nodes.front());
+        REQUIRE(CpuTopology::cpusForSearcher(ThreadBinding::Numa, numSearchers - 1, numSearchers) == nodes.back());
+    }
+
+    SECTION("Test binding the current thread")
+    {
+#ifdef __linux__
+        const auto& allowed = CpuTopology::allowedCpus();
+        REQUIRE(CpuTopology::bindCurrentThread({ allowed.front() }));
+        REQUIRE(CpuTopology::bindCurrentThread(allowed));
+#endif
+        REQUIRE_FALSE(CpuTopology::bindCurrentThread({}));
+    }
+
+    SECTION("Test scoped affinity")
+    {
+#ifdef __linux__
+        const auto before = CpuTopology::currentThreadCpus();
+        REQUIRE(before == CpuTopology::allowedCpus());
+
+        {
+            const ScopedThreadAffinity affinity;
+            REQUIRE(CpuTopology::bindCurrentThread({ before.front() }));
+            REQUIRE(CpuTopology::currentThreadCpus() == CpuList { before.front() });
+        }
+
+        REQUIRE(CpuTopology::currentThreadCpus() == before);
+#endif
+    }
+
+    SECTION("Test bound search keeps the caller affinity")
+    {
+        /* a synchronous search runs the primary searcher on the calling thread - eg. bench */
+        core::TranspositionTable::setSizeMb(16);
+
+        const auto before = CpuTopology::currentThreadCpus();
+        const auto board = parsing::FenParser::parse(s_startPosFen);
+        REQUIRE(board.has_value());
+
+        for (const auto binding : { ThreadBinding::Cores, ThreadBinding::Numa }) {
+            evaluation::Evaluator evaluator;
+            evaluator.setThreadBinding(binding);
+            evaluator.resizeSearchers(2);
+
+            std::ignore = evaluator.getBestMove(*board, 6);
+            REQUIRE(CpuTopology::currentThreadCpus() == before);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "parsing/fen_parser.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <thread>
+
+#define private public
+#include "core/time_manager.h"
+#include "evaluation/evaluator.h"
+
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+namespace {
+
+/* the engine runs several threads and CI runners can be loaded - only catch gross overshoots
+ * the actual latencies are tracked by 'bench latency' */
+constexpr auto s_maxOvershoot = 100ms;
+
+}
+
+TEST_CASE("Test Time Manager", "[TimeManager]")
+{
+    const auto board = parsing::FenParser::parse(s_startPosFen);
+    REQUIRE(board.has_value());
+
+    TimeManager::reset();
+
+    SECTION("Test the timer thread times out without a search")
+    {
+        TimeManager::setMoveTime(50);
+        TimeManager::start(*board);
+
+        const auto deadline = TimeManager::getDeadline();
+        REQUIRE(deadline.has_value());
+        REQUIRE_FALSE(TimeManager::hasTimedOut());
+
+        while (!TimeManager::hasTimedOut()) {
+            std::this_thread::sleep_for(100us);
+        }
+
+        const auto overshoot = steady_clock::now() - *deadline;
+        INFO("timeout overshoot: " << duration_cast<microseconds>(overshoot).count() << "us");
+
+        REQUIRE(overshoot >= 0ms);
+        REQUIRE(overshoot < s_maxOvershoot);
+        REQUIRE_FALSE(TimeManager::getDeadline().has_value());
+    }
+
+    SECTION("Test infinite search and stop")
+    {
+        TimeManager::startInfinite();
+        REQUIRE_FALSE(TimeManager::getDeadline().has_value());
+
+        std::this_thread::sleep_for(20ms);
+        REQUIRE_FALSE(TimeManager::hasTimedOut());
+
+        TimeManager::stop();
+        REQUIRE(TimeManager::hasTimedOut());
+    }
+
+    SECTION("Test a stopped deadline doesn't time out the next search")
+    {
+        TimeManager::setMoveTime(10);
+        TimeManager::start(*board);
+        TimeManager::stop();
+
+        TimeManager::reset();
+        TimeManager::startInfinite();
+
+        std::this_thread::sleep_for(30ms);
+        REQUIRE_FALSE(TimeManager::hasTimedOut());
+
+        TimeManager::stop();
+    }
+
+    SECTION("Test the node limit is exact")
+    {
+        core::TranspositionTable::setSizeMb(16);
+        interface::setSearchInfoEnabled(false);
+
+        evaluation::Evaluator evaluator;
+
+        for (const uint64_t nodeLimit : { 100, 1000, 5000, 50000 }) {
+            evaluator.reset();
+            TimeManager::setNodeLimit(nodeLimit);
+
+            const auto move = evaluator.getBestMove(*board);
+
+            INFO("node limit: " << nodeLimit << " nodes searched: " << evaluator.getNodes());
+            REQUIRE_FALSE(move.isNull());
+            REQUIRE(evaluator.getNodes() <= nodeLimit);
+        }
+
+        TimeManager::reset();
+        interface::setSearchInfoEnabled(true);
+    }
+
+    SECTION("Test the gap between the deadline and bestmove")
+    {
+        core::TranspositionTable::setSizeMb(16);
+        interface::setSearchInfoEnabled(false);
+
+        for (const std::size_t threads : { 1, 2 }) {
+            evaluation::Evaluator evaluator;
+            evaluator.resizeSearchers(threads);
+
+            for (const uint64_t moveTime : { 50, 200 }) {
+                evaluator.reset();
+                TimeManager::setMoveTime(moveTime);
+                TimeManager::start(*board);
+                core::TranspositionTable::newSearch();
+
+                /* the soft limit could end the search between iterations before the deadline
+                 * without it only the timer thread can stop the search */
+                TimeManager::s_softTimeLimit = TimeManager::Duration::max();
+
+                const auto deadline = TimeManager::getDeadline();
+                REQUIRE(deadline.has_value());
+
+                const auto move = evaluator.startIterativeDeepening(s_maxSearchDepth, *board);
+                const auto gap = steady_clock::now() - *deadline;
+
+                INFO("threads: " << threads << " movetime: " << moveTime << "ms - bestmove after deadline: "
+                                 << duration_cast<microseconds>(gap).count() << "us");
+
+                REQUIRE_FALSE(move.isNull());
+                REQUIRE(gap >= 0ms);
+                REQUIRE(gap < s_maxOvershoot);
+            }
+        }
+
+        interface::setSearchInfoEnabled(true);
+    }
+
+    TimeManager::reset();
+}
@@ -4,6 +4,7 @@
 
 #define private public
 #include <core/transposition.h>
+#include <core/tt_overlay.h>
 
 using namespace core;
 
@@ -129,7 +130,9 @@ TEST_CASE("Transposition Table - Collision Handling", "[TT]")
     core::TranspositionTable::setSizeMb(16);
 
     uint64_t key1 = 0x1111111111111111;
-    uint64_t key2 = key1 + TranspositionTable::s_tableSize; // Forces collision
+    uint64_t key2 = key1 ^ 0xFFFF; // Same bucket, different verification key
+
+    REQUIRE(TranspositionTable::computeHashIndex(key1) == TranspositionTable::computeHashIndex(key2));
 
     const auto move1 = movegen::Move::create(A2, A4, false);
     const auto move2 = movegen::Move::create(D7, D7, false);
@@ -140,7 +143,10 @@ TEST_CASE("Transposition Table - Collision Handling", "[TT]")
     auto retrieved1 = TranspositionTable::probe(key1);
     auto retrieved2 = TranspositionTable::probe(key2);
 
-    REQUIRE_FALSE(retrieved1.has_value());
+    /* both entries fit in the same bucket */
+    REQUIRE(retrieved1.has_value());
+    REQUIRE(retrieved1->score == 30);
+    REQUIRE(retrieved1->move == move1);
 
     REQUIRE(retrieved2.has_value());
     REQUIRE(retrieved2->score == 99);
@@ -149,6 +155,79 @@ TEST_CASE("Transposition Table - Collision Handling", "[TT]")
     REQUIRE(retrieved2->info.pv() == false);
 }
 
+TEST_CASE("Transposition Table - Bucket Replacement", "[TT]")
+{
+    core::TranspositionTable::setSizeMb(16);
+
+    constexpr uint64_t baseKey = 0x2222222222220000;
+    constexpr auto entries = TtBucket::s_entries;
+    const auto move = movegen::Move::create(A2, A4, false);
+
+    /* fill the bucket - entry 0 is the shallowest */
+    for (uint64_t i = 0; i < entries; i++) {
+        TranspositionTable::writeEntry(baseKey + i + 1, 10, 0, move, false, 10 + i, ply, TtExact);
+    }
+
+    SECTION("Shallowest entry is replaced")
+    {
+        TranspositionTable::writeEntry(baseKey + entries + 1, 10, 0, move, false, 1, ply, TtExact);
+
+        REQUIRE_FALSE(TranspositionTable::probe(baseKey + 1).has_value());
+        REQUIRE(TranspositionTable::probe(baseKey + entries + 1).has_value());
+
+        for (uint64_t i = 1; i < entries; i++) {
+            REQUIRE(TranspositionTable::probe(baseKey + i + 1).has_value());
+        }
+    }
+
+    SECTION("Stale entry is replaced before shallow entry")
+    {
+        TranspositionTable::newSearch();
+        TranspositionTable::newSearch();
+
+        /* refresh all but the deepest entry */
+        for (uint64_t i = 0; i < entries - 1; i++) {
+            TranspositionTable::writeEntry(baseKey + i + 1, 10, 0, move, false, 0, ply, TtExact);
+        }
+
+        TranspositionTable::writeEntry(baseKey + entries + 1, 10, 0, move, false, 1, ply, TtExact);
+
+        REQUIRE_FALSE(TranspositionTable::probe(baseKey + entries).has_value());
+        REQUIRE(TranspositionTable::probe(baseKey + entries + 1).has_value());
+        REQUIRE(TranspositionTable::probe(baseKey + 1).has_value());
+    }
+}
+
+TEST_CASE("Transposition Table - Hash Full", "[TT]")
+{
+    core::TranspositionTable::setSizeMb(16);
+
+    REQUIRE(TranspositionTable::getHashFull() == 0);
+
+    const auto move = movegen::Move::create(A2, A4, false);
+
+    /* fill every sampled bucket completely */
+    for (size_t i = 0; i < 1000; i++) {
+        for (size_t j = 0; j < TtBucket::s_entries; j++) {
+            auto& bucket = TranspositionTable::s_table[i];
+            bucket.keys[j] = j + 1;
+            bucket.data[j] = TtEntryData {
+                .depth = depth,
+                .info = TtInfo(TtExact, false, TranspositionTable::s_generation),
+                .score = 0,
+                .eval = 0,
+                .move = move,
+            };
+        }
+    }
+
+    REQUIRE(TranspositionTable::getHashFull() == 1000);
+
+    /* entries from previous searches are not counted */
+    TranspositionTable::newSearch();
+    REQUIRE(TranspositionTable::getHashFull() == 0);
+}
+
 TEST_CASE("Transposition Table - absolute mating Scores", "[TT]")
 {
     core::TranspositionTable::setSizeMb(16);
@@ -183,6 +262,31 @@ TEST_CASE("Transposition Table - Clear Functionality", "[TT]")
     REQUIRE_FALSE(retrieved.has_value()); // Should be cleared
 }
 
+TEST_CASE("Transposition Table - Parallel Clear", "[TT]")
+{
+    ThreadPool threadPool(4);
+    core::TranspositionTable::setSizeMb(16, &threadPool);
+
+    const auto move = movegen::Move::create(A2, A4, false);
+
+    /* spread entries across the whole table so every chunk has something to clear */
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 64; i++) {
+        keys.push_back(i * (std::numeric_limits<uint64_t>::max() / 64) + 0x1234);
+    }
+
+    for (const auto key : keys) {
+        TranspositionTable::writeEntry(key, 77, 0, move, false, depth, ply, TtExact);
+        REQUIRE(TranspositionTable::probe(key).has_value());
+    }
+
+    TranspositionTable::clear(&threadPool);
+
+    for (const auto key : keys) {
+        REQUIRE_FALSE(TranspositionTable::probe(key).has_value());
+    }
+}
+
 TEST_CASE("Transposition Table - Write eval only", "[TT]")
 {
     core::TranspositionTable::setSizeMb(16);
@@ -272,3 +376,102 @@ TEST_CASE("Transposition Table - Test entry", "[TT]")
         REQUIRE(*test == nearMate); /* score should be converted from absolute -> relative again */
     }
 }
+
+TEST_CASE("Transposition Table - Writer Tracking", "[TT]")
+{
+    core::TranspositionTable::setSizeMb(16);
+
+    const uint64_t baseKey = 0xABCDEF0000000000;
+    const auto move = movegen::Move::create(A2, A4, false);
+
+    SECTION("Test writers are not tracked by default")
+    {
+        TranspositionTable::writeEntry(baseKey + 1, 10, 0, move, false, depth, ply, TtExact, 3);
+        REQUIRE(TranspositionTable::getWriter(baseKey + 1) == 0);
+    }
+
+    SECTION("Test writers are tracked per entry")
+    {
+        TranspositionTable::setTrackWriters(true);
+
+        for (size_t i = 0; i < TtBucket::s_entries; i++) {
+            TranspositionTable::writeEntry(baseKey + i + 1, 10, 0, move, false, depth, ply, TtExact, TranspositionTable::writerIdFromIndex(i));
+        }
+
+        for (size_t i = 0; i < TtBucket::s_entries; i++) {
+            REQUIRE(TranspositionTable::getWriter(baseKey + i + 1) == i + 1);
+        }
+
+        /* a deeper write from another searcher takes over the entry */
+        TranspositionTable::writeEntry(baseKey + 1, 10, 0, move, false, depth + 1, ply, TtExact, TranspositionTable::writerIdFromIndex(4));
+        REQUIRE(TranspositionTable::getWriter(baseKey + 1) == 5);
+        REQUIRE(TranspositionTable::getWriter(baseKey + 2) == 2);
+
+        TranspositionTable::setTrackWriters(false);
+    }
+
+    SECTION("Test writer ids wrap around")
+    {
+        REQUIRE(TranspositionTable::writerIdFromIndex(0) == 1);
+        REQUIRE(TranspositionTable::writerIdFromIndex(14) == 15);
+        REQUIRE(TranspositionTable::writerIdFromIndex(15) == 1);
+    }
+}
+
+TEST_CASE("Transposition Table - Overlay", "[TT]")
+{
+    core::TranspositionTable::setSizeMb(16);
+
+    TtOverlay overlay;
+    REQUIRE_FALSE(overlay.isEnabled());
+
+    overlay.resize(1000);
+    REQUIRE(overlay.isEnabled());
+    REQUIRE(overlay.m_entries.size() == 1024);
+
+    const uint64_t key = 0x123456789ABCDEF;
+    const auto move = movegen::Move::create(A2, A4, false);
+    const Score mateScore = s_mateValue - 10;
+
+    SECTION("Writes are buffered until merged")
+    {
+        overlay.writeEntry(key, mateScore, 12, move, true, depth, ply, TtExact);
+
+        const auto buffered = overlay.probe(key);
+        REQUIRE(buffered.has_value());
+        REQUIRE(buffered->move == move);
+        REQUIRE(buffered->info.pv());
+        REQUIRE_FALSE(TranspositionTable::probe(key).has_value());
+
+        /* full keys are compared - same index is not a hit */
+        REQUIRE_FALSE(overlay.probe(key + overlay.m_entries.size()).has_value());
+
+        overlay.mergeInto(1);
+        REQUIRE_FALSE(overlay.probe(key).has_value());
+
+        const auto merged = TranspositionTable::probe(key);
+        REQUIRE(merged.has_value());
+        REQUIRE(merged->score == buffered->score);
+        REQUIRE(merged->move == buffered->move);
+        REQUIRE(merged->depth == depth);
+        REQUIRE(merged->info.pv());
+        REQUIRE(testEntry(*merged, ply, depth, s_minScore, s_maxScore) == mateScore);
+    }
+
+    SECTION("Same replacement rules as the table")
+    {
+        overlay.writeEntry(key, 10, 12, move, false, depth, ply, TtExact);
+
+        /* shallower entry is ignored */
+        overlay.writeEntry(key, 20, 12, move, false, depth - 1, ply, TtBeta);
+        REQUIRE(overlay.probe(key)->score == 10);
+
+        /* deeper entry without a move keeps the move */
+        overlay.writeEntry(key, 30, 12, movegen::nullMove(), false, depth + 1, ply, TtBeta);
+        REQUIRE(overlay.probe(key)->score == 30);
+        REQUIRE(overlay.probe(key)->move == move);
+    }
+
+    overlay.resize(0);
+    REQUIRE_FALSE(overlay.isEnabled());
+}
@@ -0,0 +1,139 @@
+#include <catch2/catch_test_macros.hpp>
+#include <latch>
+#include <numeric>
+#include <stdexcept>
+
+#define private public
+#include "core/work_stealing_pool.h"
+
+namespace {
+
+/* spawns a subjob per branch and waits for them - only works if waiting helps out */
+uint64_t fibonacci(WorkStealingPool& pool, uint64_t n)
+{
+    if (n < 2) {
+        return n;
+    }
+
+    auto first = pool.submit(fibonacci, std::ref(pool), n - 1);
+    auto second = pool.submit(fibonacci, std::ref(pool), n - 2);
+
+    return pool.get(first) + pool.get(second);
+}
+
+}
+
+TEST_CASE("Test Work Stealing Pool", "[WorkStealingPool]")
+{
+    SECTION("Test constructor thread size")
+    {
+        WorkStealingPool singlePool { 1 };
+        REQUIRE(singlePool.size() == 1);
+
+        WorkStealingPool sizedPool { 4 };
+        REQUIRE(sizedPool.size() == 4);
+        REQUIRE(sizedPool.m_queues.size() == 4);
+    }
+
+    SECTION("Test submit returns results")
+    {
+        WorkStealingPool pool { 4 };
+
+        auto future = pool.submit([](int a, int b) { return a + b; }, 2, 3);
+        REQUIRE(pool.get(future) == 5);
+
+        auto voidFuture = pool.submit([] {});
+        pool.get(voidFuture);
+    }
+
+    SECTION("Test submission is unbounded")
+    {
+        WorkStealingPool pool { 2 };
+
+        const std::size_t iterations = 10000;
+        std::vector<WorkStealingPool::Future<std::size_t>> futures;
+
+        for (std::size_t i = 0; i < iterations; i++) {
+            futures.push_back(pool.submit([i] { return i; }));
+        }
+
+        std::size_t sum = 0;
+        for (auto& future : futures) {
+            sum += pool.get(future);
+        }
+
+        REQUIRE(sum == iterations * (iterations - 1) / 2);
+    }
+
+    SECTION("Test nested jobs")
+    {
+        /* more waiting jobs than workers - would deadlock if waiting didn't run other jobs */
+        WorkStealingPool pool { 2 };
+        REQUIRE(pool.get(pool.submit(fibonacci, std::ref(pool), 18)) == 2584);
+    }
+
+    SECTION("Test continuations")
+    {
+        WorkStealingPool pool { 3 };
+
+        auto future = pool.then(pool.submit([] { return 20; }), [](int value) { return value * 2 + 2; });
+        REQUIRE(pool.get(future) == 42);
+
+        auto voidFuture = pool.then(pool.submit([] {}), [] { return true; });
+        REQUIRE(pool.get(voidFuture));
+    }
+
+    SECTION("Test continuations are queued when the job completes")
+    {
+        WorkStealingPool pool { 1 };
+
+        std::latch started(1);
+        std::latch release(1);
+        auto future = pool.submit([&] {
+            started.count_down();
+            release.wait();
+            return 1;
+        });
+
+        started.wait();
+
+        /* stored on the running job - nothing is queued yet */
+        auto continuation = pool.then(std::move(future), [](int value) { return value + 1; });
+        auto chained = pool.then(std::move(continuation), [](int value) { return value * 2; });
+        REQUIRE(pool.m_pendingJobs == 0);
+
+        release.count_down();
+        REQUIRE(pool.get(chained) == 4);
+
+        /* the result is already there - the continuation still runs */
+        auto completed = pool.submit([] { return 5; });
+        completed.wait();
+        REQUIRE(pool.get(pool.then(std::move(completed), [](int value) { return value; })) == 5);
+    }
+
+    SECTION("Test exceptions are forwarded to the future")
+    {
+        WorkStealingPool pool { 2 };
+
+        auto future = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+        REQUIRE_THROWS_AS(pool.get(future), std::runtime_error);
+    }
+
+    SECTION("Test all workers are used")
+    {
+        const std::size_t threads = 4;
+        WorkStealingPool pool { threads };
+
+        /* every job blocks until all workers are running a job */
+        std::latch allRunning(threads);
+        std::vector<WorkStealingPool::Future<void>> futures;
+
+        for (std::size_t i = 0; i < threads; i++) {
+            futures.push_back(pool.submit([&allRunning] { allRunning.arrive_and_wait(); }));
+        }
+
+        for (auto& future : futures) {
+            future.get();
+        }
+    }
+}
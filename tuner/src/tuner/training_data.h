@@ -78,16 +78,6 @@ inline std::optional<double> parseResult(std::string_view sv)
     return std::nullopt;
 }
 
-inline uint8_t computePhase(const BitBoard& board)
-{
-    uint8_t phase = 0;
-    for (const auto piece : magic_enum::enum_values<Piece>()) {
-        phase += std::popcount(board.pieces[piece]) * s_piecePhaseValues[piece];
-    }
-
-    return phase;
-}
-
 inline bool unpackTrainingData(std::array<TrainingData, s_positions>& data)
 {
     if (!std::filesystem::exists(trainingDataPath)) {
@@ -117,7 +107,7 @@ inline bool unpackTrainingData(std::array<TrainingData, s_positions>& data)
         if (board.has_value() && res.has_value()) {
             std::ignore = staticEval.get(*board);
 
-            const uint8_t phase = computePhase(*board);
+            const uint8_t phase = board->phase;
             const PFactors pFactors { phase / 24.0, (24.0 - phase) / 24.0 };
 
             /* NOTE: must be called after static evaluation to reflect weights of that given eval */